@@ -4,62 +4,101 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 CPP_SRCS += \
+../src/Automorphism.cpp \
+../src/BinaryStream.cpp \
 ../src/BootKey.cpp \
 ../src/CZZ.cpp \
 ../src/CZZX.cpp \
 ../src/Ciphertext.cpp \
+../src/Ciphertext3.cpp \
 ../src/Context.cpp \
+../src/DiagonalCache.cpp \
+../src/EvalModPlan.cpp \
 ../src/EvaluatorUtils.cpp \
 ../src/HEAAN.cpp \
 ../src/Key.cpp \
+../src/KeyStore.cpp \
+../src/LevelKeyCache.cpp \
 ../src/NumUtils.cpp \
+../src/PackedCiphertext.cpp \
 ../src/Params.cpp \
 ../src/Plaintext.cpp \
 ../src/Ring2Utils.cpp \
+../src/RingMultiplier.cpp \
 ../src/Scheme.cpp \
 ../src/SchemeAlgo.cpp \
+../src/ScratchArena.cpp \
 ../src/SecretKey.cpp \
+../src/SerializationUtils.cpp \
+../src/SparsePoly.cpp \
 ../src/StringUtils.cpp \
+../src/TaskScheduler.cpp \
 ../src/TestScheme.cpp \
 ../src/TimeUtils.cpp 
 
 OBJS += \
+./src/Automorphism.o \
+./src/BinaryStream.o \
 ./src/BootKey.o \
 ./src/CZZ.o \
 ./src/CZZX.o \
 ./src/Ciphertext.o \
+./src/Ciphertext3.o \
 ./src/Context.o \
+./src/DiagonalCache.o \
+./src/EvalModPlan.o \
 ./src/EvaluatorUtils.o \
 ./src/HEAAN.o \
 ./src/Key.o \
+./src/KeyStore.o \
+./src/LevelKeyCache.o \
 ./src/NumUtils.o \
+./src/PackedCiphertext.o \
 ./src/Params.o \
 ./src/Plaintext.o \
 ./src/Ring2Utils.o \
+./src/RingMultiplier.o \
 ./src/Scheme.o \
 ./src/SchemeAlgo.o \
+./src/ScratchArena.o \
 ./src/SecretKey.o \
+./src/SerializationUtils.o \
+./src/SparsePoly.o \
 ./src/StringUtils.o \
+./src/TaskScheduler.o \
 ./src/TestScheme.o \
 ./src/TimeUtils.o 
 
 CPP_DEPS += \
+./src/Automorphism.d \
+./src/BinaryStream.d \
 ./src/BootKey.d \
 ./src/CZZ.d \
 ./src/CZZX.d \
 ./src/Ciphertext.d \
+./src/Ciphertext3.d \
 ./src/Context.d \
+./src/DiagonalCache.d \
+./src/EvalModPlan.d \
 ./src/EvaluatorUtils.d \
 ./src/HEAAN.d \
 ./src/Key.d \
+./src/KeyStore.d \
+./src/LevelKeyCache.d \
 ./src/NumUtils.d \
+./src/PackedCiphertext.d \
 ./src/Params.d \
 ./src/Plaintext.d \
 ./src/Ring2Utils.d \
+./src/RingMultiplier.d \
 ./src/Scheme.d \
 ./src/SchemeAlgo.d \
+./src/ScratchArena.d \
 ./src/SecretKey.d \
+./src/SerializationUtils.d \
+./src/SparsePoly.d \
 ./src/StringUtils.d \
+./src/TaskScheduler.d \
 ./src/TestScheme.d \
 ./src/TimeUtils.d 
 
@@ -0,0 +1,19 @@
+#include "Automorphism.h"
+
+#include "RingMultiplier.h"
+
+Automorphism::Automorphism(long pow, long logN) : logN(logN) {
+	N = 1 << logN;
+	long M = N << 1;
+	this->pow = pow % M;
+
+	nttIndex = new long[N];
+	for (long j = 0; j < N; ++j) {
+		long ipow = ((2 * RingMultiplier::bitReverse(j, logN) + 1) * this->pow) % M;
+		nttIndex[j] = RingMultiplier::bitReverse((ipow - 1) >> 1, logN);
+	}
+}
+
+Automorphism::~Automorphism() {
+	delete[] nttIndex;
+}
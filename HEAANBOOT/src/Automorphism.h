@@ -0,0 +1,34 @@
+#ifndef HEAAN_AUTOMORPHISM_H_
+#define HEAAN_AUTOMORPHISM_H_
+
+using namespace std;
+
+/**
+ * Index table of automorphism X -> X^pow of Z[X] / (X^N + 1) for odd pow in NTT form of RingMultiplier,
+ * where it is a permutation of evaluation points: point j of p(X^pow) is point nttIndex[j] of p.
+ * In coefficient form Ring2Utils::inpower computes the signed permutation from pow,
+ * a table does not pay off there as copying of big coefficients dominates
+ */
+class Automorphism {
+public:
+
+	long pow; ///< odd power modulo 2N
+	long logN;
+	long N;
+
+	long* nttIndex; ///< source evaluation point of every evaluation point in bit-reversed order
+
+	/**
+	 * @param[in] pow odd power
+	 * @param[in] logN log of ring dimension
+	 */
+	Automorphism(long pow, long logN);
+
+	Automorphism(const Automorphism& o) = delete;
+
+	Automorphism& operator=(const Automorphism& o) = delete;
+
+	virtual ~Automorphism();
+};
+
+#endif
@@ -0,0 +1,191 @@
+#include "BinaryStream.h"
+
+#include <cstring>
+#include <stdexcept>
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t fnv(uint64_t hash, const unsigned char* bytes, long n) {
+	for (long i = 0; i < n; ++i) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+static void wordToBytes(unsigned char* bytes, uint64_t x) {
+	for (long i = 0; i < 8; ++i) {
+		bytes[i] = (unsigned char) (x >> (8 * i));
+	}
+}
+
+static uint64_t bytesToWord(const unsigned char* bytes) {
+	uint64_t x = 0;
+	for (long i = 0; i < 8; ++i) {
+		x |= (uint64_t) bytes[i] << (8 * i);
+	}
+	return x;
+}
+
+static void writeRaw(ostream& out, uint64_t x, long n) {
+	unsigned char bytes[8];
+	wordToBytes(bytes, x);
+	out.write((const char*) bytes, n);
+}
+
+static uint64_t readRaw(istream& in, long n) {
+	unsigned char bytes[8] = {0};
+	in.read((char*) bytes, n);
+	if(in.gcount() != n) {
+		throw runtime_error("unexpected end of binary stream");
+	}
+	return bytesToWord(bytes);
+}
+
+//-----------------------------------------
+
+void BinaryWriter::begin(uint32_t type) {
+	writeRaw(out, SERIAL_MAGIC, 4);
+	writeRaw(out, SERIAL_VERSION, 4);
+	writeRaw(out, type, 4);
+	checksum = FNV_OFFSET;
+}
+
+void BinaryWriter::end() {
+	writeRaw(out, checksum, 8);
+	if(!out) {
+		throw runtime_error("binary stream write failed");
+	}
+}
+
+void BinaryWriter::writeBytes(const unsigned char* bytes, long n) {
+	checksum = fnv(checksum, bytes, n);
+	out.write((const char*) bytes, n);
+}
+
+void BinaryWriter::writeLong(long x) {
+	unsigned char bytes[8];
+	wordToBytes(bytes, (uint64_t) x);
+	writeBytes(bytes, 8);
+}
+
+void BinaryWriter::writeDouble(double x) {
+	uint64_t w;
+	memcpy(&w, &x, 8);
+	writeLong((long) w);
+}
+
+void BinaryWriter::writeZZ(const ZZ& x, long limbs) {
+	long nbytes = limbs * 8;
+	unsigned char* bytes = new unsigned char[nbytes];
+	if(sign(x) < 0) {
+		BytesFromZZ(bytes, x + power2_ZZ(8 * nbytes), nbytes);
+	} else {
+		BytesFromZZ(bytes, x, nbytes);
+	}
+	writeBytes(bytes, nbytes);
+	delete[] bytes;
+}
+
+void BinaryWriter::writePoly(ZZX& p, long degree) {
+	long len = min(degree, p.rep.length());
+	long bits = 0;
+	for (long i = 0; i < len; ++i) {
+		bits = max(bits, NumBits(p.rep[i]));
+	}
+	long limbs = numLimbs(bits);
+	writeLong(degree);
+	writeLong(limbs);
+
+	long nbytes = limbs * 8;
+	ZZ shift = power2_ZZ(8 * nbytes);
+	unsigned char* bytes = new unsigned char[degree * nbytes];
+	memset(bytes, 0, degree * nbytes);
+	for (long i = 0; i < len; ++i) {
+		if(sign(p.rep[i]) < 0) {
+			BytesFromZZ(bytes + i * nbytes, p.rep[i] + shift, nbytes);
+		} else {
+			BytesFromZZ(bytes + i * nbytes, p.rep[i], nbytes);
+		}
+	}
+	writeBytes(bytes, degree * nbytes);
+	delete[] bytes;
+}
+
+long BinaryWriter::numLimbs(long bits) {
+	return bits / 64 + 1;
+}
+
+//-----------------------------------------
+
+void BinaryReader::begin(uint32_t type) {
+	if(readRaw(in, 4) != SERIAL_MAGIC) {
+		throw runtime_error("binary stream is not a HEAAN record");
+	}
+	if(readRaw(in, 4) != SERIAL_VERSION) {
+		throw runtime_error("unsupported version of binary format");
+	}
+	if(readRaw(in, 4) != type) {
+		throw runtime_error("unexpected type of binary record");
+	}
+	checksum = FNV_OFFSET;
+}
+
+void BinaryReader::end() {
+	if(readRaw(in, 8) != checksum) {
+		throw runtime_error("checksum mismatch in binary record");
+	}
+}
+
+void BinaryReader::readBytes(unsigned char* bytes, long n) {
+	in.read((char*) bytes, n);
+	if(in.gcount() != n) {
+		throw runtime_error("unexpected end of binary stream");
+	}
+	checksum = fnv(checksum, bytes, n);
+}
+
+long BinaryReader::readLong() {
+	unsigned char bytes[8];
+	readBytes(bytes, 8);
+	return (long) bytesToWord(bytes);
+}
+
+double BinaryReader::readDouble() {
+	uint64_t w = (uint64_t) readLong();
+	double x;
+	memcpy(&x, &w, 8);
+	return x;
+}
+
+void BinaryReader::readZZ(ZZ& x, long limbs) {
+	long nbytes = limbs * 8;
+	unsigned char* bytes = new unsigned char[nbytes];
+	readBytes(bytes, nbytes);
+	ZZFromBytes(x, bytes, nbytes);
+	if(bytes[nbytes - 1] & 0x80) {
+		x -= power2_ZZ(8 * nbytes);
+	}
+	delete[] bytes;
+}
+
+void BinaryReader::readPoly(ZZX& p) {
+	long degree = readLong();
+	long limbs = readLong();
+	if(degree < 0 || degree > (1L << 24) || limbs <= 0 || limbs > (1L << 16)) {
+		throw runtime_error("invalid polynomial in binary record");
+	}
+	long nbytes = limbs * 8;
+	ZZ shift = power2_ZZ(8 * nbytes);
+	unsigned char* bytes = new unsigned char[degree * nbytes];
+	readBytes(bytes, degree * nbytes);
+	p.SetLength(degree);
+	for (long i = 0; i < degree; ++i) {
+		ZZFromBytes(p.rep[i], bytes + i * nbytes, nbytes);
+		if(bytes[(i + 1) * nbytes - 1] & 0x80) {
+			p.rep[i] -= shift;
+		}
+	}
+	delete[] bytes;
+}
@@ -0,0 +1,97 @@
+#ifndef HEAAN_BINARYSTREAM_H_
+#define HEAAN_BINARYSTREAM_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+
+#include <iostream>
+#include <stdint.h>
+
+using namespace std;
+using namespace NTL;
+
+static const uint32_t SERIAL_MAGIC = 0x4E414548; ///< "HEAN" in little-endian bytes, starts every record
+static const uint32_t SERIAL_VERSION = 2; ///< version of binary format, readers reject other versions
+
+/**
+ * Writer of binary records: header (magic, version, type), payload and FNV-1a checksum of payload.
+ * Integers are written as little-endian words, big integers as fixed number of 64-bit limbs in two's complement
+ */
+class BinaryWriter {
+public:
+
+	ostream& out;
+	uint64_t checksum; ///< FNV-1a hash of payload written since begin
+
+	BinaryWriter(ostream& out) : out(out), checksum(0) {}
+
+	/**
+	 * starts record
+	 * @param[in] type type of record
+	 */
+	void begin(uint32_t type);
+
+	/**
+	 * finishes record with checksum of its payload
+	 */
+	void end();
+
+	void writeBytes(const unsigned char* bytes, long n);
+
+	void writeLong(long x);
+
+	void writeDouble(double x);
+
+	/**
+	 * @param[in] x integer with absolute value less than 2^(64 * limbs - 1)
+	 * @param[in] limbs number of 64-bit limbs
+	 */
+	void writeZZ(const ZZ& x, long limbs);
+
+	/**
+	 * writes number of limbs needed for largest coefficient and all coefficients with that width
+	 * @param[in] p polynomial
+	 * @param[in] degree number of coefficients
+	 */
+	void writePoly(ZZX& p, long degree);
+
+	/**
+	 * @return number of 64-bit limbs in two's complement enough for integers of bits bits
+	 */
+	static long numLimbs(long bits);
+};
+
+/**
+ * Reader of records of BinaryWriter, throws runtime_error on wrong header, truncated input or checksum mismatch
+ */
+class BinaryReader {
+public:
+
+	istream& in;
+	uint64_t checksum; ///< FNV-1a hash of payload read since begin
+
+	BinaryReader(istream& in) : in(in), checksum(0) {}
+
+	/**
+	 * starts record and checks its header
+	 * @param[in] type expected type of record
+	 */
+	void begin(uint32_t type);
+
+	/**
+	 * finishes record and checks checksum of its payload
+	 */
+	void end();
+
+	void readBytes(unsigned char* bytes, long n);
+
+	long readLong();
+
+	double readDouble();
+
+	void readZZ(ZZ& x, long limbs);
+
+	void readPoly(ZZX& p);
+};
+
+#endif
@@ -1,79 +1,269 @@
 #include "BootKey.h"
 
-BootKey::BootKey(Context& context, long pBits, long l) : pBits(pBits) {
-	ZZ pmod = power2_ZZ(pBits);
+BootKey::BootKey(Context& context, long pBits, long l, long levels) : pBits(pBits), logSize(l), cache(NULL), levels(levels) {
+	if(levels > 0) {
+		generateFactored(context, l);
+		return;
+	}
 
-	ZZX ex;
-	long lh = l/2;
 	long lpow = 1 << l;
-	long lpow2 = lpow << 1;
-	long Noverl = context.N >> l;
+	pvec.resize(lpow);
+	pvecInv.resize(lpow);
+	long prec = RR::precision();
+	NTL_EXEC_RANGE(lpow, first, last);
+	RR::SetPrecision(prec);
+	for (long j = first; j < last; ++j) {
+		pvec[j] = encodeDense(context, j, false);
+		pvecInv[j] = encodeDense(context, j, true);
+	}
+	NTL_EXEC_RANGE_END;
+}
 
-	long lk = 1 << lh;
-	long lm = 1 << (l - lh);
+BootKey::BootKey(Context& context, long pBits, long l, DiagonalCache* cache) : pBits(pBits), logSize(l), cache(cache), levels(0) {
+}
 
-	pvec = new ZZX[lpow];
-	pvecInv = new ZZX[lpow];
+shared_ptr<SparsePoly> BootKey::diagonal(Context& context, long j, bool inv) {
+	if(cache == NULL) {
+		return shared_ptr<SparsePoly>(shared_ptr<SparsePoly>(), inv ? &pvecInv[j] : &pvec[j]);
+	}
+	long key = ((j << 1) + (inv ? 1 : 0)) * 64 + logSize;
+	shared_ptr<SparsePoly> res = cache->find(key);
+	if(!res) {
+		res = make_shared<SparsePoly>(encodeDense(context, j, inv));
+		cache->insert(key, res);
+	}
+	return res;
+}
+
+SparsePoly BootKey::encodeDense(Context& context, long j, bool inv) {
+	long lh = logSize / 2;
+	long lpow = 1 << logSize;
+	long lpow2 = lpow << 1;
+	long Noverl = context.N >> logSize;
+	long lk = 1 << lh;
 
 	CZZ* pdvals = new CZZ[lpow2];
-	for (long j = 0; j < lpow; ++j) {
-		for (long i = j; i < lpow; ++i) {
-			long deg =((2 * context.N - context.rotGroup[i]) * (i - j) * Noverl) % (2 * context.N);
-			CZZ tmp = EvaluatorUtils::evalCZZ(context.ksiPowsr[deg], context.ksiPowsi[deg], pBits);
-			long idx = (context.rotGroup[i-j] % (2 * lpow2)  - 1) / 2;
-					pdvals[idx] = tmp;
-					pdvals[lpow2 - idx - 1] = tmp.conjugate();
+	for (long i = 0; i < lpow; ++i) {
+		long d = (lpow + i - j) % lpow;
+		long deg = inv ? (context.rotGroup[d] * i * Noverl) % (2 * context.N)
+				: ((2 * context.N - context.rotGroup[i]) * d * Noverl) % (2 * context.N);
+		CZZ tmp = EvaluatorUtils::evalCZZ(context.ksiPowsr[deg], context.ksiPowsi[deg], pBits);
+		long idx = (context.rotGroup[d] % (2 * lpow2) - 1) / 2;
+		pdvals[idx] = tmp;
+		pdvals[lpow2 - idx - 1] = tmp.conjugate();
+	}
+	NumUtils::fftSpecialInv(pdvals, lpow2, context.ksiPowsr, context.ksiPowsi, context.M);
+
+	SparsePoly res = encodeDiagonal(context, pdvals, lpow2, j < lk ? 1 : context.rotGroup[lpow - lk * (j / lk)]);
+	delete[] pdvals;
+	return res;
+}
+
+SparsePoly BootKey::encodeDiagonal(Context& context, CZZ* pdvals, long size2, long pow) {
+	ZZ pmod = power2_ZZ(pBits);
+	long gap = context.N / size2;
+	ZZX p;
+	p.SetLength(context.N);
+	long idx = 0;
+	for (long i = 0; i < size2; ++i) {
+		p.rep[idx] = pdvals[i].r;
+		idx += gap;
+	}
+	if(pow != 1) {
+		p = Ring2Utils::inpower(p, pow, pmod, context.N);
+	}
+	return SparsePoly(p, gap, context);
+}
+
+void BootKey::generateFactored(Context& context, long l) {
+	long size = 1 << l;
+	long sizeh = size >> 1;
+	long layers = l - 1;
+	levels = min(levels, max(layers, 1L));
+
+	long* first = new long[levels + 1];
+	first[0] = 0;
+	for (long i = 0; i < levels; ++i) {
+		first[i + 1] = first[i] + layers / levels + (i < layers % levels ? 1 : 0);
+	}
+
+	SlotsMatrix fold, halves, merge;
+	fold[0] = new RR[2 * size];
+	fold[sizeh] = new RR[2 * size];
+	halves[0] = new RR[2 * size];
+	merge[0] = new RR[2 * size];
+	merge[sizeh] = new RR[2 * size];
+	for (long r = 0; r < size; ++r) {
+		bool low = r < sizeh;
+		fold[0][r] = 1;
+		fold[sizeh][r] = 1;
+		halves[0][r] = low ? 1 : 0;
+		halves[0][size + r] = low ? 0 : -1;
+		merge[0][r] = low ? 1 : 0;
+		merge[0][size + r] = low ? 0 : 1;
+		merge[sizeh][r] = low ? 0 : 1;
+		merge[sizeh][size + r] = low ? 1 : 0;
+	}
+
+	ctsNum.resize(levels);
+	ctsRot.resize(levels);
+	ctsPvec.resize(levels);
+	for (long i = 0; i < levels; ++i) {
+		SlotsMatrix stage = i == 0 ? fold : SlotsMatrix();
+		for (long k = first[i]; k < first[i + 1]; ++k) {
+			SlotsMatrix layer = fftLayer(context, size, sizeh >> k);
+			SlotsMatrix layerAdj = adjoint(layer, size);
+			stage = stage.empty() ? layerAdj : compose(layerAdj, stage, size);
 		}
-		for (long i = 0; i < j; ++i) {
-			long deg =((2 * context.N - context.rotGroup[i]) * (lpow + i - j) * Noverl) % (2 * context.N);
-			CZZ tmp = EvaluatorUtils::evalCZZ(context.ksiPowsr[deg], context.ksiPowsi[deg], pBits);
-			long idx = (context.rotGroup[lpow + i - j] % (2 * lpow2) - 1) / 2;
-			pdvals[idx] = tmp;
-			pdvals[lpow2 - idx - 1] = tmp.conjugate();
+		if(i == levels - 1) {
+			stage = compose(halves, stage, size);
 		}
+		encodeMatrix(ctsNum[i], ctsRot[i], ctsPvec[i], context, stage, size);
+	}
 
-		NumUtils::fftSpecialInv(pdvals, lpow2, context.ksiPowsr, context.ksiPowsi, context.M);
+	stcNum.resize(levels);
+	stcRot.resize(levels);
+	stcPvec.resize(levels);
+	for (long i = 0; i < levels; ++i) {
+		long j = levels - 1 - i;
+		SlotsMatrix stage = i == 0 ? merge : SlotsMatrix();
+		for (long k = first[j + 1] - 1; k >= first[j]; --k) {
+			SlotsMatrix layer = fftLayer(context, size, sizeh >> k);
+			stage = stage.empty() ? layer : compose(layer, stage, size);
+		}
+		encodeMatrix(stcNum[i], stcRot[i], stcPvec[i], context, stage, size);
+	}
+	delete[] first;
+}
 
-		pvec[j].SetLength(context.N);
-		long idx = 0;
-		long gap = context.N / lpow2;
-		for (long i = 0; i < lpow2; ++i) {
-			pvec[j].rep[idx] = pdvals[i].r;
-			idx += gap;
+SlotsMatrix BootKey::fftLayer(Context& context, long size, long blockSize) {
+	long blockSizeh = blockSize >> 1;
+	long blockSize4 = blockSize << 2;
+	long gap = context.M / blockSize4;
+
+	SlotsMatrix res;
+	res[0] = new RR[2 * size];
+	res[blockSizeh] = new RR[2 * size];
+	res[size - blockSizeh] = new RR[2 * size];
+	RR* diag0 = res[0];
+	RR* diagp = res[blockSizeh];
+	RR* diagm = res[size - blockSizeh];
+
+	for (long r = 0; r < size; ++r) {
+		long rho = r % blockSize;
+		long deg = (context.rotGroup[rho] % blockSize4) * gap;
+		if(rho < blockSizeh) {
+			diag0[r] = 1;
+			diagp[r] = context.ksiPowsr[deg];
+			diagp[size + r] = context.ksiPowsi[deg];
+		} else {
+			diagm[r] = 1;
+			diag0[r] = context.ksiPowsr[deg];
+			diag0[size + r] = context.ksiPowsi[deg];
 		}
 	}
+	return res;
+}
 
-	for (long j = 0; j < lpow; ++j) {
-		for (long i = j; i < lpow; ++i) {
-			long deg =(context.rotGroup[i-j] * i * Noverl) % (2 * context.N);
-			CZZ tmp = EvaluatorUtils::evalCZZ(context.ksiPowsr[deg], context.ksiPowsi[deg], pBits);
-			long idx = (context.rotGroup[i-j] % (2 * lpow2) - 1) / 2;
-			pdvals[idx] = tmp;
-			pdvals[lpow2 - idx - 1] = tmp.conjugate();
+SlotsMatrix BootKey::compose(SlotsMatrix& m1, SlotsMatrix& m2, long size) {
+	SlotsMatrix res;
+	for (SlotsMatrix::iterator it1 = m1.begin(); it1 != m1.end(); ++it1) {
+		for (SlotsMatrix::iterator it2 = m2.begin(); it2 != m2.end(); ++it2) {
+			long d = (it1->first + it2->first) % size;
+			if(res.find(d) == res.end()) {
+				res[d] = new RR[2 * size];
+			}
+			RR* diag = res[d];
+			RR* diag1 = it1->second;
+			RR* diag2 = it2->second;
+			long d1 = it1->first;
+			long prec = RR::precision();
+			NTL_EXEC_RANGE(size, first, last);
+			RR::SetPrecision(prec);
+			for (long r = first; r < last; ++r) {
+				long rr = (r + d1) % size;
+				diag[r] += diag1[r] * diag2[rr] - diag1[size + r] * diag2[size + rr];
+				diag[size + r] += diag1[r] * diag2[size + rr] + diag1[size + r] * diag2[rr];
+			}
+			NTL_EXEC_RANGE_END;
 		}
-		for (long i = 0; i < j; ++i) {
-			long deg = (context.rotGroup[lpow + i - j] * i * Noverl) % (2 * context.N);
-			CZZ tmp = EvaluatorUtils::evalCZZ(context.ksiPowsr[deg], context.ksiPowsi[deg], pBits);
-			long idx = (context.rotGroup[lpow + i - j] % (2 * lpow2) - 1) / 2;
-			pdvals[idx] = tmp;
-			pdvals[lpow2 - idx - 1] = tmp.conjugate();
+	}
+	for (SlotsMatrix::iterator it = m1.begin(); it != m1.end(); ++it) {
+		delete[] it->second;
+	}
+	for (SlotsMatrix::iterator it = m2.begin(); it != m2.end(); ++it) {
+		delete[] it->second;
+	}
+	m1.clear();
+	m2.clear();
+	return res;
+}
+
+SlotsMatrix BootKey::adjoint(SlotsMatrix& m, long size) {
+	SlotsMatrix res;
+	for (SlotsMatrix::iterator it = m.begin(); it != m.end(); ++it) {
+		long d = it->first;
+		RR* diag = new RR[2 * size];
+		for (long r = 0; r < size; ++r) {
+			long rr = (r + size - d) % size;
+			diag[r] = it->second[rr];
+			diag[size + r] = -it->second[size + rr];
 		}
-		NumUtils::fftSpecialInv(pdvals, lpow2, context.ksiPowsr, context.ksiPowsi, context.M);
-
-		pvecInv[j].SetLength(context.N);
-		long idx = 0;
-		long gap = context.N / lpow2;
-		for (long i = 0; i < lpow2; ++i) {
-			pvecInv[j].rep[idx] = pdvals[i].r;
-			idx += gap;
+		res[(size - d) % size] = diag;
+		delete[] it->second;
+	}
+	m.clear();
+	return res;
+}
+
+void BootKey::encodeMatrix(long& num, vector<long>& rot, vector<SparsePoly>& pvec, Context& context, SlotsMatrix& m, long size) {
+	long size2 = size << 1;
+	long size4 = size << 2;
+	long total = m.size();
+
+	long* offsets = new long[total];
+	RR** diags = new RR*[total];
+	long k = 0;
+	for (SlotsMatrix::iterator it = m.begin(); it != m.end(); ++it, ++k) {
+		offsets[k] = it->first;
+		diags[k] = it->second;
+	}
+	m.clear();
+
+	vector<SparsePoly> encoded(total);
+	bool* isZero = new bool[total];
+	long prec = RR::precision();
+	NTL_EXEC_RANGE(total, first, last);
+	RR::SetPrecision(prec);
+	CZZ* pdvals = new CZZ[size2];
+	for (long t = first; t < last; ++t) {
+		RR* diag = diags[t];
+		isZero[t] = true;
+		for (long r = 0; r < size; ++r) {
+			CZZ tmp = EvaluatorUtils::evalCZZ(diag[r], diag[size + r], pBits);
+			if(tmp.r != 0 || tmp.i != 0) isZero[t] = false;
+			long idx = (context.rotGroup[r] % size4 - 1) / 2;
+			pdvals[idx] = tmp;
+			pdvals[size2 - idx - 1] = tmp.conjugate();
 		}
+		delete[] diag;
+		if(isZero[t]) continue;
+
+		NumUtils::fftSpecialInv(pdvals, size2, context.ksiPowsr, context.ksiPowsi, context.M);
+		encoded[t] = encodeDiagonal(context, pdvals, size2);
 	}
 	delete[] pdvals;
+	NTL_EXEC_RANGE_END;
 
-	for (long i = 1; i < lm; ++i) {
-		for (long j = 0; j < lk; ++j) {
-			pvec[j + lk * i] = Ring2Utils::inpower(pvec[j + lk * i], context.rotGroup[lpow - lk * i], pmod, context.N);
-			pvecInv[j + lk * i] = Ring2Utils::inpower(pvecInv[j + lk * i], context.rotGroup[lpow - lk * i], pmod, context.N);
-		}
+	rot.clear();
+	pvec.clear();
+	for (long t = 0; t < total; ++t) {
+		if(isZero[t]) continue;
+		pvec.push_back(encoded[t]);
+		rot.push_back(offsets[t]);
 	}
+	num = pvec.size();
+	delete[] offsets;
+	delete[] diags;
+	delete[] isZero;
 }
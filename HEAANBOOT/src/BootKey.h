@@ -3,21 +3,131 @@
 
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
+#include <NTL/BasicThreadPool.h>
+
+#include <vector>
 
 #include "CZZ.h"
 #include "EvaluatorUtils.h"
 #include "NumUtils.h"
 #include "Ring2Utils.h"
 #include "Context.h"
+#include "SparsePoly.h"
+#include "DiagonalCache.h"
+
+/**
+ * Diagonals of a sparse matrix acting on vectors of slots with period size:
+ * (M * v)_r = sum over offsets d of diag_d[r] * v_{r + d},
+ * each diagonal is stored as size real parts followed by size imaginary parts
+ */
+typedef map<long, RR*> SlotsMatrix;
 
 class BootKey {
 public:
 	long pBits;
 
-	ZZX* pvec;
-	ZZX* pvecInv;
+	long logSize; ///< log of matrix size
+
+	vector<SparsePoly> pvec; ///< encoded diagonals of dense CoeffToSlot matrix, empty if levels > 0 or cache is used
+	vector<SparsePoly> pvecInv; ///< encoded diagonals of dense SlotToCoeff matrix, empty if levels > 0 or cache is used
+
+	DiagonalCache* cache; ///< dense diagonals are generated on demand and kept here, NULL if they are stored
+
+	long levels; ///< number of stages in factored CoeffToSlot and SlotToCoeff, 0 for dense matrices
+
+	vector<long> ctsNum; ///< number of diagonals in each stage of factored CoeffToSlot
+	vector<vector<long> > ctsRot; ///< left rotations of diagonals in each stage of factored CoeffToSlot
+	vector<vector<SparsePoly> > ctsPvec; ///< encoded diagonals in each stage of factored CoeffToSlot
+
+	vector<long> stcNum; ///< number of diagonals in each stage of factored SlotToCoeff
+	vector<vector<long> > stcRot; ///< left rotations of diagonals in each stage of factored SlotToCoeff
+	vector<vector<SparsePoly> > stcPvec; ///< encoded diagonals in each stage of factored SlotToCoeff
+
+	/**
+	 * empty BootKey to be filled by a reader
+	 */
+	BootKey() : pBits(0), logSize(0), cache(NULL), levels(0) {}
+
+	/**
+	 * diagonals are kept as sparse polynomials with 2^(l+1) coefficients instead of N,
+	 * with residues in NTT form if context has RNS multiplier
+	 * @param[in] context context
+	 * @param[in] pBits precision bits of encoded diagonals
+	 * @param[in] l log of matrix size
+	 * @param[in] levels 0 for dense matrices evaluated with baby-step giant-step,
+	 * otherwise number of sparse FFT stages (more stages use less rotations and consume more levels)
+	 */
+	BootKey(Context& context, long pBits, long l, long levels = 0);
+
+	/**
+	 * lazy BootKey for dense matrices: no diagonal is generated here,
+	 * each one is encoded when a linear transform first needs it and kept in cache
+	 * @param[in] context context
+	 * @param[in] pBits precision bits of encoded diagonals
+	 * @param[in] l log of matrix size
+	 * @param[in] cache cache of diagonals, can be shared by BootKeys of different sizes
+	 */
+	BootKey(Context& context, long pBits, long l, DiagonalCache* cache);
+
+	/**
+	 * @param[in] j index of diagonal
+	 * @param[in] inv false for CoeffToSlot, true for SlotToCoeff
+	 * @return j-th encoded diagonal of dense matrix, from cache or newly encoded if BootKey is lazy
+	 */
+	shared_ptr<SparsePoly> diagonal(Context& context, long j, bool inv);
+
+	/**
+	 * encodes j-th diagonal of dense CoeffToSlot or SlotToCoeff matrix,
+	 * composed with X -> X^pow of its giant step for baby-step giant-step evaluation
+	 * @param[in] j index of diagonal
+	 * @param[in] inv false for CoeffToSlot, true for SlotToCoeff
+	 */
+	SparsePoly encodeDense(Context& context, long j, bool inv);
+
+	/**
+	 * generates sparse stages of factored CoeffToSlot and SlotToCoeff,
+	 * bit reversal of special FFT is skipped in both, so they are only used as a pair
+	 * @param[in] l log of matrix size
+	 */
+	void generateFactored(Context& context, long l);
+
+	//-----------------------------------------
+
+	/**
+	 * butterfly layer of special FFT on blocks of slots
+	 * @param[in] size period of slots
+	 * @param[in] blockSize size of butterfly blocks, divides size / 2
+	 */
+	static SlotsMatrix fftLayer(Context& context, long size, long blockSize);
+
+	/**
+	 * @return matrix m1 * m2 (m2 is applied first), inputs are deleted
+	 */
+	static SlotsMatrix compose(SlotsMatrix& m1, SlotsMatrix& m2, long size);
+
+	/**
+	 * @return conjugate transpose of m, m is deleted
+	 */
+	static SlotsMatrix adjoint(SlotsMatrix& m, long size);
+
+	/**
+	 * encodes one diagonal from its values after special inverse FFT
+	 * @param[in] pdvals values of diagonal after fftSpecialInv
+	 * @param[in] size2 number of values, twice the number of slots
+	 * @param[in] pow the encoding is composed with X -> X^pow
+	 * @return encoding scaled by 2^pBits as sparse polynomial
+	 */
+	SparsePoly encodeDiagonal(Context& context, CZZ* pdvals, long size2, long pow = 1);
 
-	BootKey(Context& context, long pBits, long l);
+	/**
+	 * encodes diagonals of m as plaintext polynomials scaled by 2^pBits, zero diagonals are skipped,
+	 * encodings are stored as sparse polynomials with N / (2 * size) coefficients
+	 * @param[out] num number of encoded diagonals
+	 * @param[out] rot left rotations of diagonals
+	 * @param[out] pvec encoded diagonals
+	 * @param[in] m matrix, deleted
+	 */
+	void encodeMatrix(long& num, vector<long>& rot, vector<SparsePoly>& pvec, Context& context, SlotsMatrix& m, long size);
 };
 
 #endif
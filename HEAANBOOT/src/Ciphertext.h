@@ -29,10 +29,35 @@ public:
 	 * @param[in] bits: bits in cipher
 	 * @param[in] slots: number of slots
 	 */
-	Ciphertext(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero(), ZZ mod = ZZ::zero(), long cbits = 0, long slots = 1, bool isComplex = true) : ax(ax), bx(bx), mod(mod), cbits(cbits), slots(slots), isComplex(isComplex) {}
+	Ciphertext(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero(), ZZ mod = ZZ::zero(), long cbits = 0, long slots = 1, bool isComplex = true) : cbits(cbits), slots(slots), isComplex(isComplex) {
+		swap(this->ax, ax);
+		swap(this->bx, bx);
+		swap(this->mod, mod);
+	}
 
 	Ciphertext(const Ciphertext& o) : ax(o.ax), bx(o.bx), mod(o.mod), cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {}
 
+	/**
+	 * takes polynomials of o without copying them, o is left empty
+	 */
+	Ciphertext(Ciphertext&& o) : cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {
+		swap(ax, o.ax);
+		swap(bx, o.bx);
+		swap(mod, o.mod);
+	}
+
+	Ciphertext& operator=(const Ciphertext& o) = default;
+
+	Ciphertext& operator=(Ciphertext&& o) {
+		swap(ax, o.ax);
+		swap(bx, o.bx);
+		swap(mod, o.mod);
+		cbits = o.cbits;
+		slots = o.slots;
+		isComplex = o.isComplex;
+		return *this;
+	}
+
 };
 
 #endif
@@ -0,0 +1 @@
+#include "Ciphertext3.h"
@@ -0,0 +1,68 @@
+#ifndef HEAAN_CIPHERTEXT3_H_
+#define HEAAN_CIPHERTEXT3_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Cipher of degree 2 consist three elements (ax, bx, axax) of ring Z_qi[X] / (X^N + 1),
+ * result of multiplication before linearization, decrypts as bx + ax * sx + axax * sx^2
+ *
+ */
+class Ciphertext3 {
+public:
+
+	ZZX ax;
+	ZZX bx;
+	ZZX axax;
+
+	ZZ mod; ///< mod in cipher
+	long cbits; ///< bits in cipher
+	long slots; ///< number of slots
+
+	bool isComplex;
+	//-----------------------------------------
+
+	/**
+	 * Ciphertext3 = (bx = mx + ex - ax * sx - axax * sx^2, ax, axax) for secret key sx and error ex
+	 * @param[in] bits: bits in cipher
+	 * @param[in] slots: number of slots
+	 */
+	Ciphertext3(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero(), ZZX axax = ZZX::zero(), ZZ mod = ZZ::zero(), long cbits = 0, long slots = 1, bool isComplex = true) : cbits(cbits), slots(slots), isComplex(isComplex) {
+		swap(this->ax, ax);
+		swap(this->bx, bx);
+		swap(this->axax, axax);
+		swap(this->mod, mod);
+	}
+
+	Ciphertext3(const Ciphertext3& o) : ax(o.ax), bx(o.bx), axax(o.axax), mod(o.mod), cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {}
+
+	/**
+	 * takes polynomials of o without copying them, o is left empty
+	 */
+	Ciphertext3(Ciphertext3&& o) : cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {
+		swap(ax, o.ax);
+		swap(bx, o.bx);
+		swap(axax, o.axax);
+		swap(mod, o.mod);
+	}
+
+	Ciphertext3& operator=(const Ciphertext3& o) = default;
+
+	Ciphertext3& operator=(Ciphertext3&& o) {
+		swap(ax, o.ax);
+		swap(bx, o.bx);
+		swap(axax, o.axax);
+		swap(mod, o.mod);
+		cbits = o.cbits;
+		slots = o.slots;
+		isComplex = o.isComplex;
+		return *this;
+	}
+
+};
+
+#endif
@@ -1,8 +1,7 @@
 #include "Context.h"
 
-
-Context::Context(Params& params) :
-	logN(params.logN), logq(params.logq), sigma(params.sigma), h(params.h), N(params.N) {
+Context::Context(Params& params, long backend) :
+	logN(params.logN), logq(params.logq), sigma(params.sigma), h(params.h), N(params.N), backend(backend) {
 
 	M = N << 1;
 	logqq = 2 * logq;
@@ -29,14 +28,49 @@ Context::Context(Params& params) :
 	ksiPowsr[M] = ksiPowsr[0];
 	ksiPowsi[M] = ksiPowsi[0];
 
+	ksiPowsDouble = new complex<double>[M + 1];
+	ksiPowsLongDouble = new complex<long double>[M + 1];
+
+	long double PiL = acosl(-1.0L);
+	for (long j = 0; j < M; ++j) {
+		long double angle = 2.0L * PiL * j / M;
+		ksiPowsLongDouble[j] = complex<long double>(cosl(angle), sinl(angle));
+		ksiPowsDouble[j] = complex<double>((double) cosl(angle), (double) sinl(angle));
+	}
+
+	ksiPowsDouble[M] = ksiPowsDouble[0];
+	ksiPowsLongDouble[M] = ksiPowsLongDouble[0];
+
 	taylorCoeffsMap.insert(pair<string, double*>(LOGARITHM, new double[11]{0,1,-0.5,1./3,-1./4,1./5,-1./6,1./7,-1./8,1./9,-1./10}));
 	taylorCoeffsMap.insert(pair<string, double*>(EXPONENT, new double[11]{1,1,0.5,1./6,1./24,1./120,1./720,1./5040, 1./40320,1./362880,1./3628800}));
 	taylorCoeffsMap.insert(pair<string, double*>(SIGMOID, new double[11]{1./2,1./4,0,-1./48,0,1./480,0,-17./80640,0,31./1451520,0}));
+
+	multiplier = NULL;
+	if(backend == BACKEND_RNS) {
+		multiplier = new RingMultiplier(logN, logq);
+	}
+}
+
+Automorphism& Context::automorphism(long pow) {
+	lock_guard<mutex> guard(automorphismLock);
+	map<long, Automorphism*>::iterator it = automorphismMap.find(pow);
+	if(it == automorphismMap.end()) {
+		it = automorphismMap.insert(pair<long, Automorphism*>(pow, new Automorphism(pow, logN))).first;
+	}
+	return *it->second;
 }
 
 Context::~Context() {
+	for (map<long, Automorphism*>::iterator it = automorphismMap.begin(); it != automorphismMap.end(); ++it) {
+		delete it->second;
+	}
 	delete[] rotGroup;
 	delete[] ksiPowsi;
 	delete[] ksiPowsr;
+	delete[] ksiPowsDouble;
+	delete[] ksiPowsLongDouble;
+	if(multiplier != NULL) {
+		delete multiplier;
+	}
 }
 
@@ -3,8 +3,14 @@
 
 #include <NTL/RR.h>
 
+#include <mutex>
+
+#include "Automorphism.h"
 #include "Common.h"
 #include "Params.h"
+#include "RingMultiplier.h"
+
+#include <complex>
 
 using namespace std;
 using namespace NTL;
@@ -15,6 +21,9 @@ static string LOGARITHM = "Logarithm"; ///< log(x)
 static string EXPONENT  = "Exponent"; ///< exp(x)
 static string SIGMOID   = "Sigmoid"; ///< sigmoid(x) = exp(x) / (1 + exp(x))
 
+static const long BACKEND_ZZX = 0; ///< ring multiplication with NTL ZZX arithmetic
+static const long BACKEND_RNS = 1; ///< ring multiplication with RNS and NTT over word-sized primes
+
 class Context {
 public:
 
@@ -33,11 +42,32 @@ public:
 	long* rotGroup; ///< auxiliary information about rotation group indexes for batch encoding
 	RR* ksiPowsr; ///< storing ksi pows for fft calculation
 	RR* ksiPowsi; ///< storing ksi pows for fft calculation
+	complex<double>* ksiPowsDouble; ///< storing ksi pows for double precision fft calculation
+	complex<long double>* ksiPowsLongDouble; ///< storing ksi pows for extended precision fft calculation
 	map<string, double*> taylorCoeffsMap; ///< storing taylor coefficients for function calculation
 
-	Context(Params& params);
+	long backend; ///< BACKEND_ZZX or BACKEND_RNS
+	RingMultiplier* multiplier; ///< RNS multiplier, NULL for BACKEND_ZZX
+
+	/**
+	 * @param[in] params parameters
+	 * @param[in] backend ring multiplication backend, the RNS multiplier is owned by context and passed to products of Ring2Utils
+	 */
+	Context(Params& params, long backend = BACKEND_ZZX);
+
+	/**
+	 * safe to call from concurrent tasks
+	 * @param[in] pow odd power, usually an entry of rotGroup
+	 * @return NTT index table of automorphism X -> X^pow, built on first use and kept with the context
+	 */
+	Automorphism& automorphism(long pow);
 
 	virtual ~Context();
+
+private:
+
+	map<long, Automorphism*> automorphismMap; ///< NTT index tables of automorphisms by power
+	mutex automorphismLock;
 };
 
 #endif /* CONTEXT_H_ */
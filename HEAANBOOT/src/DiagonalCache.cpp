@@ -0,0 +1,36 @@
+#include "DiagonalCache.h"
+
+shared_ptr<SparsePoly> DiagonalCache::find(long key) {
+	lock_guard<mutex> guard(lock);
+	map<long, EntryList::iterator>::iterator it = index.find(key);
+	if(it == index.end()) {
+		return shared_ptr<SparsePoly>();
+	}
+	entries.splice(entries.begin(), entries, it->second);
+	return it->second->second;
+}
+
+void DiagonalCache::insert(long key, shared_ptr<SparsePoly> poly) {
+	lock_guard<mutex> guard(lock);
+	map<long, EntryList::iterator>::iterator it = index.find(key);
+	if(it != index.end()) {
+		entries.erase(it->second);
+	}
+	entries.push_front(make_pair(key, poly));
+	index[key] = entries.begin();
+	while((long) entries.size() > capacity && !entries.empty()) {
+		index.erase(entries.back().first);
+		entries.pop_back();
+	}
+}
+
+long DiagonalCache::size() {
+	lock_guard<mutex> guard(lock);
+	return entries.size();
+}
+
+void DiagonalCache::clear() {
+	lock_guard<mutex> guard(lock);
+	entries.clear();
+	index.clear();
+}
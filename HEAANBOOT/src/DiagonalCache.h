@@ -0,0 +1,59 @@
+#ifndef HEAAN_DIAGONALCACHE_H_
+#define HEAAN_DIAGONALCACHE_H_
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "SparsePoly.h"
+
+using namespace std;
+
+static const long DIAGONAL_CACHE_CAPACITY = 256; ///< default number of diagonals kept by DiagonalCache
+
+/**
+ * Bounded cache of encoded diagonals of lazy BootKeys with least recently used eviction.
+ * Diagonals are shared, so an evicted diagonal is freed once the last transform using it is done.
+ * Methods are safe to call from concurrent tasks
+ */
+class DiagonalCache {
+public:
+
+	long capacity; ///< maximal number of cached diagonals
+
+	/**
+	 * @param[in] capacity maximal number of cached diagonals
+	 */
+	DiagonalCache(long capacity = DIAGONAL_CACHE_CAPACITY) : capacity(capacity) {}
+
+	/**
+	 * @param[in] key key of diagonal
+	 * @return cached diagonal marked as most recently used, empty pointer if it is not cached
+	 */
+	shared_ptr<SparsePoly> find(long key);
+
+	/**
+	 * caches diagonal and evicts least recently used diagonals over capacity
+	 * @param[in] key key of diagonal
+	 * @param[in] poly diagonal
+	 */
+	void insert(long key, shared_ptr<SparsePoly> poly);
+
+	/**
+	 * @return number of cached diagonals
+	 */
+	long size();
+
+	void clear();
+
+private:
+
+	typedef list<pair<long, shared_ptr<SparsePoly> > > EntryList;
+
+	EntryList entries; ///< cached diagonals, most recently used first
+	map<long, EntryList::iterator> index; ///< position of every key in entries
+	mutex lock;
+};
+
+#endif
@@ -0,0 +1,168 @@
+#include "EvalModPlan.h"
+
+#include "Context.h"
+
+EvalModPlan::EvalModPlan(long logI, long logT, long doubleAngles, long degree) : logI(logI), logT(logT), doubleAngles(doubleAngles), degree(degree) {
+	depth = evalDepth(degree, doubleAngles);
+	mults = evalMults(degree, doubleAngles);
+	if(degree == 0) {
+		errorBits = 0;
+		return;
+	}
+	long n = degree + 1;
+	coeffs.resize(n);
+	RR scale = to_RR(1L << logI);
+	RR shift = to_RR(0.25);
+	RR angle = 2 * Pi / to_RR(1L << doubleAngles);
+	RR* vals = new RR[n];
+	for (long j = 0; j < n; ++j) {
+		RR node = cos(Pi * (j + 0.5) / n);
+		vals[j] = cos(angle * (scale * node - shift));
+	}
+	for (long k = 0; k < n; ++k) {
+		RR sum = to_RR(0);
+		for (long j = 0; j < n; ++j) {
+			sum += vals[j] * cos(Pi * k * (j + 0.5) / n);
+		}
+		coeffs[k] = 2 * sum / n;
+	}
+	coeffs[0] /= 2;
+	delete[] vals;
+
+	long nref = numRefCoeffs(logI, degree);
+	long double* ref = chebyshevCoeffs(logI, doubleAngles, nref);
+	errorBits = estimateErrorBits(ref, nref, degree, doubleAngles);
+	delete[] ref;
+}
+
+EvalModPlan EvalModPlan::plan(long logI, long logT, long precisionBits, long maxDegree) {
+	long maxDepth = logI + logT + 3;
+	long bestAngles = -1;
+	long bestDegree = 0;
+	long bestDepth = 0;
+	long bestMults = 0;
+	long nref = numRefCoeffs(logI, maxDegree);
+	for (long r = 0; r <= logI + logT; ++r) {
+		long double* ref = chebyshevCoeffs(logI, r, nref);
+		for (long d = 1; d <= maxDegree; ++d) {
+			if(estimateErrorBits(ref, nref, d, r) <= -precisionBits) {
+				long dep = evalDepth(d, r);
+				long mults = evalMults(d, r);
+				if(dep <= maxDepth && (bestAngles < 0 || mults < bestMults || (mults == bestMults && dep < bestDepth))) {
+					bestAngles = r;
+					bestDegree = d;
+					bestDepth = dep;
+					bestMults = mults;
+				}
+				break;
+			}
+		}
+		delete[] ref;
+	}
+	if(bestAngles < 0) {
+		throw invalid_argument("precision is not reachable with maxDegree within depth of Taylor evaluation");
+	}
+	return EvalModPlan(logI, logT, bestAngles, bestDegree);
+}
+
+//-----------------------------------------
+
+long double EvalModPlan::evalTarget(long double u, long logI, long doubleAngles) {
+	long double pi = acosl(-1.0L);
+	return cosl(2 * pi * ((1L << logI) * u - 0.25L) / (1L << doubleAngles));
+}
+
+long double* EvalModPlan::chebyshevCoeffs(long logI, long doubleAngles, long n) {
+	long double pi = acosl(-1.0L);
+	long double* vals = new long double[n];
+	for (long j = 0; j < n; ++j) {
+		vals[j] = evalTarget(cosl(pi * (j + 0.5L) / n), logI, doubleAngles);
+	}
+	long double* res = new long double[n];
+	for (long k = 0; k < n; ++k) {
+		long double sum = 0;
+		for (long j = 0; j < n; ++j) {
+			sum += vals[j] * cosl(pi * k * (j + 0.5L) / n);
+		}
+		res[k] = 2 * sum / n;
+	}
+	res[0] /= 2;
+	delete[] vals;
+	return res;
+}
+
+double EvalModPlan::estimateErrorBits(long double* tail, long n, long degree, long doubleAngles) {
+	long double err = 0;
+	for (long k = degree + 1; k < n; ++k) {
+		err += fabsl(tail[k]);
+	}
+	// interpolation adds aliased tail once more, every step cos(2x) = 2cos(x)^2 - 1 multiplies error by at most 4
+	return log2((double) (2 * err)) + 2 * doubleAngles;
+}
+
+long EvalModPlan::numRefCoeffs(long logI, long maxDegree) {
+	return 2 * maxDegree + (8L << logI) + 32;
+}
+
+long EvalModPlan::logBabyStep(long degree) {
+	long best = 0;
+	long bestMults = -1;
+	for (long l = 1; (1L << (l - 1)) <= degree; ++l) {
+		long mults = seriesMults(degree, l);
+		if(bestMults < 0 || mults < bestMults) {
+			best = l;
+			bestMults = mults;
+		}
+	}
+	return best;
+}
+
+long EvalModPlan::seriesMults(long degree, long logBaby) {
+	long baby = 1L << logBaby;
+	if(degree < baby) {
+		return max(degree - 1, 0L);
+	}
+	long n = baby;
+	long giants = 0;
+	while (2 * n <= degree) {
+		n <<= 1;
+		giants++;
+	}
+	// baby steps T_2, ..., T_baby, giant steps and one product with a giant step for every split with nonconstant quotient
+	long res = baby - 1 + giants;
+	vector<long> stack(1, degree);
+	while (!stack.empty()) {
+		long d = stack.back();
+		stack.pop_back();
+		if(d < baby) continue;
+		long m = baby;
+		while (2 * m <= d) {
+			m <<= 1;
+		}
+		if(d > m) {
+			res++;
+			stack.push_back(d - m);
+		}
+		stack.push_back(m - 1);
+	}
+	return res;
+}
+
+long EvalModPlan::evalDepth(long degree, long doubleAngles) {
+	long logBaby = logBabyStep(degree);
+	long logDegree = 0;
+	if(degree < (1L << logBaby)) {
+		while ((1L << logDegree) < degree) {
+			logDegree++;
+		}
+		return logDegree + 1 + doubleAngles;
+	}
+	while ((2L << logDegree) <= degree) {
+		logDegree++;
+	}
+	return logDegree + 2 + doubleAngles;
+}
+
+long EvalModPlan::evalMults(long degree, long doubleAngles) {
+	return seriesMults(degree, logBabyStep(degree)) + doubleAngles;
+}
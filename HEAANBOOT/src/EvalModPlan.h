@@ -0,0 +1,95 @@
+#ifndef HEAAN_EVALMODPLAN_H_
+#define HEAAN_EVALMODPLAN_H_
+
+#include <NTL/RR.h>
+
+#include <vector>
+
+#include "Common.h"
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Approximate modular reduction used in bootstrapping.
+ * For input u = (m + q0 * I) / (q0 * 2^logI) in [-1, 1]
+ * the value sin(2pi * 2^logI * u) = cos(2pi * (2^logI * u - 1/4)) is computed as
+ * Chebyshev approximation of cos(2pi * (2^logI * u - 1/4) / 2^doubleAngles)
+ * followed by doubleAngles steps cos(2x) = 2cos(x)^2 - 1, each costing one squaring.
+ * The series is evaluated with baby steps T_1, ..., T_baby and giant steps T_(baby * 2^j) (Paterson-Stockmeyer).
+ * As in Taylor evaluation of removeIpart, at most logI + logT double-angle steps are used
+ */
+class EvalModPlan {
+public:
+
+	long logI; ///< bound on log of |I|
+	long logT; ///< logT of removeIpart this plan is made for
+	long doubleAngles; ///< number of double-angle steps, at most logI + logT
+	long degree; ///< degree of Chebyshev approximation
+	vector<RR> coeffs; ///< coefficients of T_0, ..., T_degree
+
+	long depth; ///< multiplicative depth of approximation and double-angle steps
+	long mults; ///< number of key switches of approximation and double-angle steps
+	double errorBits; ///< estimated log of absolute error of sin(2pi * 2^logI * u)
+
+	EvalModPlan(long logI = 0, long logT = 0, long doubleAngles = 0, long degree = 0);
+
+	/**
+	 * chooses number of double-angle steps up to logI + logT and degree with the smallest number of key switches
+	 * within depth logI + logT + 3 of Taylor evaluation, and with the smallest depth among them
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] logT logT of removeIpart
+	 * @param[in] precisionBits required bits of precision of sin(2pi * 2^logI * u)
+	 * @param[in] maxDegree largest degree of Chebyshev approximation
+	 * @return plan with error below 2^(-precisionBits)
+	 */
+	static EvalModPlan plan(long logI, long logT, long precisionBits, long maxDegree = 127);
+
+	//-----------------------------------------
+
+	/**
+	 * @return cos(2pi * (2^logI * u - 1/4) / 2^doubleAngles) in long double precision
+	 */
+	static long double evalTarget(long double u, long logI, long doubleAngles);
+
+	/**
+	 * Chebyshev interpolation on n nodes of target function in long double precision
+	 * @return array of n coefficients of T_0, ..., T_(n-1)
+	 */
+	static long double* chebyshevCoeffs(long logI, long doubleAngles, long n);
+
+	/**
+	 * @param[in] tail Chebyshev coefficients of target function
+	 * @param[in] n number of coefficients
+	 * @return estimated log of absolute error after truncation to degree and double-angle steps
+	 */
+	static double estimateErrorBits(long double* tail, long n, long degree, long doubleAngles);
+
+	/**
+	 * @return number of reference coefficients used to estimate errors of degrees up to maxDegree
+	 */
+	static long numRefCoeffs(long logI, long maxDegree);
+
+	/**
+	 * @return log of number of baby steps with the smallest number of key switches for degree,
+	 * baby steps above degree mean evaluation without giant steps
+	 */
+	static long logBabyStep(long degree);
+
+	/**
+	 * @return number of key switches of Chebyshev series of degree with 2^logBaby baby steps
+	 */
+	static long seriesMults(long degree, long logBaby);
+
+	/**
+	 * @return multiplicative depth of Chebyshev series of degree, coefficients and double-angle steps
+	 */
+	static long evalDepth(long degree, long doubleAngles);
+
+	/**
+	 * @return number of key switches of Chebyshev series of degree and double-angle steps
+	 */
+	static long evalMults(long degree, long doubleAngles);
+};
+
+#endif
@@ -10,6 +10,20 @@ ZZ EvaluatorUtils::evalZZ(const RR& x, const long& bits) {
 	return RoundToZZ(xp);
 }
 
+ZZ EvaluatorUtils::evalZZ(const long double& x, const long& bits) {
+	int e;
+	long double m = frexpl(x, &e);
+	long mant = (long) ldexpl(m, 62);
+	RR xp = MakeRR(to_ZZ(mant), e - 62 + bits);
+	return RoundToZZ(xp);
+}
+
+long double EvaluatorUtils::evalLongDouble(const ZZ& x) {
+	long shift = max(NumBits(x) - 63, 0L);
+	ZZ mant = x >> shift;
+	return ldexpl((long double) to_long(mant), shift);
+}
+
 CZZ EvaluatorUtils::evalCZZ(const double& xr, const double& xi, const long& bits) {
 	return evalCZZ(to_RR(xr), to_RR(xi), bits);
 }
@@ -28,6 +28,21 @@ public:
 	 */
 	static ZZ evalZZ(const RR& x, const long& bits);
 
+	/**
+	 * evaluates value xr << bits
+	 * @param[in] x
+	 * @param[in] bits
+	 * @return x << bits
+	 */
+	static ZZ evalZZ(const long double& x, const long& bits);
+
+	/**
+	 * converts x to long double keeping 63 leading bits
+	 * @param[in] x
+	 * @return x as long double
+	 */
+	static long double evalLongDouble(const ZZ& x);
+
 	/**
 	 * evaluates Z[i] value (xr + i * xi) << bits
 	 * @param[in] real part
@@ -1,6 +1,48 @@
+#include <string>
+
+#include "Context.h"
 #include "TestScheme.h"
 
-int main() {
+int main(int argc, char** argv) {
+
+	//-----------------------------------------
+
+	/*
+	 * Checks of optimized paths against reference paths, run with argument "check",
+	 * exit code is 1 if any check fails
+	 */
+
+	if(argc > 1 && std::string(argv[1]) == "check") {
+		bool passed = true;
+		passed &= TestScheme::testEncodePrecision(13, 155, 4);
+		passed &= TestScheme::testRNSMult(10, 155, 30, 3);
+		passed &= TestScheme::testMultThreads(10, 155, 30, 3, 4);
+		passed &= TestScheme::testNTTSimd(13, 155);
+		passed &= TestScheme::testPartialSlotsSum(10, 155, 30, 3);
+		passed &= TestScheme::testMultKeyCopy(10, 155, 30, 3, 10);
+		passed &= TestScheme::testEvalModPlan(10, 620, 31, 2, 4, 12, 3);
+		passed &= TestScheme::testPackedCiphertext(10, 155, 30, 3, 70);
+		passed &= TestScheme::testBootKeyCompact(10, 620, 31, 2, 4, 3, BACKEND_ZZX);
+		passed &= TestScheme::testBootKeyCompact(10, 620, 31, 2, 4, 3, BACKEND_RNS);
+		passed &= TestScheme::testLazyBootKey(10, 620, 31, 2, 4, 3, 8);
+		passed &= TestScheme::testBootKeyThreads(10, 620, 35, 8, 3, 4);
+		passed &= TestScheme::testSeededKeys(10, 155, 30, 3, 0);
+		passed &= TestScheme::testSeededKeys(10, 155, 30, 3, 3);
+		passed &= TestScheme::testLinearTransformFactored(10, 620, 35, 3, 2);
+		passed &= TestScheme::testLinearTransformFactored(10, 620, 35, 9, 3);
+		passed &= TestScheme::testBootstrapParallel(10, 620, 31, 2, 4, 3, 2);
+		passed &= TestScheme::testBootstrapParallel(10, 620, 31, 2, 4, 9, 2);
+		passed &= TestScheme::testSparseBootstrap(10, 620, 31, 2, 4, 16, 3);
+		passed &= TestScheme::testFusedMult(10, 155, 30, 3, 2);
+		passed &= TestScheme::testRescaleRoundingBatch(10, 155, 30, 4, 3);
+		passed &= TestScheme::testSerialization(10, 620, 3);
+		passed &= TestScheme::testKeyStore(10, 620, 3);
+		passed &= TestScheme::testHybridKeySwitching(10, 155, 30, 4, 3, 3);
+		passed &= TestScheme::testLevelKeys(10, 620, 30, 4, 3);
+		passed &= TestScheme::testInnerProd(10, 155, 30, 3, 16);
+		passed &= TestScheme::testAutomorphism(10, 155, 3, 1);
+		return passed ? 0 : 1;
+	}
 
 	//-----------------------------------------
 
@@ -54,6 +96,15 @@ int main() {
 
 	//-----------------------------------------
 
+	/*
+	 * Params: logN, logq, precisionBits, logDegree, logSlots
+	 * Suggested: 13, 155, 30, 4, 3
+	 */
+
+//	TestScheme::testRescaleRoundingBatch(13, 155, 30, 4, 3);
+
+	//-----------------------------------------
+
 	/*
 	 * Params: logN, logq, precisionBits, degree, logSlots
 	 * Suggested: 13, 155, 30, 13, 3
@@ -136,5 +187,18 @@ int main() {
 
 //	TestScheme::testBootstrap();
 
+	/*
+	 * Params: logN, logq, logSlots
+	 * Suggested: 10, 620, 3
+	 */
+
+//	TestScheme::testSerialization(10, 620, 3);
+//	TestScheme::testMultKeyCopy(13, 155, 30, 12, 10);
+//	TestScheme::testHybridKeySwitching(13, 155, 30, 4, 3, 3);
+//	TestScheme::testLevelKeys(13, 620, 30, 4, 3);
+//	TestScheme::testInnerProd(13, 155, 30, 3, 16);
+//	TestScheme::testFusedMult(13, 155, 30, 3, 10);
+//	TestScheme::testAutomorphism(13, 155, 3, 10);
+
 	return 0;
 }
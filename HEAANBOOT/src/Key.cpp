@@ -1 +1,156 @@
 #include "Key.h"
+
+#include <cstring>
+
+Key::Key(ZZX ax, ZZX bx, const unsigned char* seed) : np(0), bits(0), isSeeded(seed != NULL), dnum(0), logP(0) {
+	swap(this->ax, ax);
+	swap(this->bx, bx);
+	if(isSeeded) {
+		memcpy(this->seed, seed, SEED_BYTES);
+	}
+}
+
+Key::Key(ZZX ax, ZZX bx, Context& context, const unsigned char* seed) : np(0), bits(0), isSeeded(seed != NULL), dnum(0), logP(0) {
+	swap(this->ax, ax);
+	swap(this->bx, bx);
+	if(isSeeded) {
+		memcpy(this->seed, seed, SEED_BYTES);
+	}
+	computeResidues(context, context.logq);
+	levels = make_shared<LevelKeyCache>();
+}
+
+Key::Key(ZZX ax, ZZX bx, Context& context, const unsigned char* seed, long multBits) : np(0), bits(0), isSeeded(seed != NULL), dnum(0), logP(0) {
+	swap(this->ax, ax);
+	swap(this->bx, bx);
+	if(isSeeded) {
+		memcpy(this->seed, seed, SEED_BYTES);
+	}
+	computeResidues(context, multBits);
+	levels = make_shared<LevelKeyCache>();
+}
+
+Key::Key(long dnum, long logP) : np(0), bits(0), isSeeded(false), dnum(dnum), logP(logP), digits(dnum) {
+	levels = make_shared<LevelKeyCache>();
+}
+
+Key::Key(Key&& o) : rax(std::move(o.rax)), rbx(std::move(o.rbx)), np(o.np), bits(o.bits), isSeeded(o.isSeeded), dnum(o.dnum), logP(o.logP),
+		digits(std::move(o.digits)), levels(std::move(o.levels)) {
+	swap(ax, o.ax);
+	swap(bx, o.bx);
+	memcpy(seed, o.seed, SEED_BYTES);
+}
+
+Key& Key::operator=(Key&& o) {
+	swap(ax, o.ax);
+	swap(bx, o.bx);
+	rax = std::move(o.rax);
+	rbx = std::move(o.rbx);
+	np = o.np;
+	bits = o.bits;
+	isSeeded = o.isSeeded;
+	memcpy(seed, o.seed, SEED_BYTES);
+	dnum = o.dnum;
+	logP = o.logP;
+	digits = std::move(o.digits);
+	levels = std::move(o.levels);
+	return *this;
+}
+
+void Key::compress() {
+	for (long i = 0; i < dnum; ++i) {
+		digits[i].compress();
+	}
+	if(levels) {
+		levels->clear();
+	}
+	if(!isSeeded) return;
+	ax = ZZX::zero();
+	rax.reset();
+}
+
+void Key::expand(Context& context) {
+	for (long i = 0; i < dnum; ++i) {
+		digits[i].expandAx(context, context.logq + logP);
+	}
+	expandAx(context, context.logqq);
+}
+
+bool Key::isCompressed() {
+	for (long i = 0; i < dnum; ++i) {
+		if(digits[i].isCompressed()) return true;
+	}
+	return isSeeded && ax.rep.length() == 0;
+}
+
+bool Key::isHybrid() {
+	return dnum > 0;
+}
+
+shared_ptr<Key> Key::atLevel(Context& context, long cbits) {
+	if(!levels) return shared_ptr<Key>();
+	long logMod = isHybrid() ? cbits + logP : cbits + context.logq;
+	logMod = (logMod + LEVEL_KEY_BITS - 1) / LEVEL_KEY_BITS * LEVEL_KEY_BITS;
+	if(logMod >= (isHybrid() ? context.logq + logP : context.logqq)) return shared_ptr<Key>();
+
+	shared_ptr<Key> res = levels->find(logMod);
+	if(res) return res;
+	if(isHybrid()) {
+		for (long i = 0; i < dnum; ++i) {
+			if(!digits[i].hasPolys(context.N)) return shared_ptr<Key>();
+		}
+		res = make_shared<Key>(dnum, logP);
+		for (long i = 0; i < dnum; ++i) {
+			res->digits[i] = digits[i].reduce(context, logMod, logP + NumBits(dnum));
+		}
+	} else {
+		if(!hasPolys(context.N)) return shared_ptr<Key>();
+		res = make_shared<Key>(reduce(context, logMod, logMod - context.logq));
+	}
+	return levels->insert(logMod, res);
+}
+
+bool Key::hasPolys(long degree) {
+	return ax.rep.length() == degree && bx.rep.length() == degree;
+}
+
+Key Key::reduce(Context& context, long logMod, long multBits) {
+	ZZ mod = power2_ZZ(logMod);
+	ZZX axr, bxr;
+	axr.SetLength(context.N);
+	bxr.SetLength(context.N);
+	for (long j = 0; j < context.N; ++j) {
+		rem(axr.rep[j], ax.rep[j], mod);
+		rem(bxr.rep[j], bx.rep[j], mod);
+	}
+	return Key(axr, bxr, context, NULL, multBits);
+}
+
+void Key::computeResidues(Context& context, long multBits) {
+	RingMultiplier* multiplier = context.multiplier;
+	if(multiplier != NULL) {
+		bits = max(RingMultiplier::maxBits(ax, context.N), RingMultiplier::maxBits(bx, context.N));
+		np = multiplier->numPrimes(bits + multBits + context.logN);
+		if(np < 0) {
+			np = 0;
+			return;
+		}
+		rax = allocResidues(np << context.logN);
+		rbx = allocResidues(np << context.logN);
+		multiplier->toNTT(rax.get(), ax, np);
+		multiplier->toNTT(rbx.get(), bx, np);
+	}
+}
+
+void Key::expandAx(Context& context, long logMod) {
+	if(!isSeeded || ax.rep.length() != 0) return;
+	NumUtils::sampleUniform2Seeded(ax, context.N, logMod, seed);
+	if(rbx) {
+		rax = allocResidues(np << context.logN);
+		context.multiplier->toNTT(rax.get(), ax, np);
+	}
+}
+
+shared_ptr<uint64_t> Key::allocResidues(long len) {
+	return shared_ptr<uint64_t>(new uint64_t[len], default_delete<uint64_t[]>());
+}
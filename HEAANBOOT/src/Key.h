@@ -3,13 +3,123 @@
 
 #include <NTL/ZZX.h>
 
+#include <memory>
+#include <vector>
+
+#include "Context.h"
+#include "LevelKeyCache.h"
+#include "NumUtils.h"
+
 using namespace NTL;
 
 class Key {
 public:
 	ZZX ax;
 	ZZX bx;
-	Key(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero()) : ax(ax), bx(bx) {}
+
+	shared_ptr<uint64_t> rax; ///< residues of ax in NTT form shared by copies, empty if Context has no RNS multiplier
+	shared_ptr<uint64_t> rbx; ///< residues of bx in NTT form shared by copies, empty if Context has no RNS multiplier
+	long np; ///< number of primes in rax and rbx
+	long bits; ///< bound on number of bits in coefficients of ax and bx
+
+	bool isSeeded; ///< ax is expanded from seed, so only seed and bx are needed to restore the key
+	unsigned char seed[SEED_BYTES]; ///< seed of ax if isSeeded
+
+	long dnum; ///< number of digits of hybrid key, 0 for key modulo qq
+	long logP; ///< log of special modulus of hybrid key, which is also the base of digits
+	vector<Key> digits; ///< keys of digits of hybrid key modulo 2^(logq + logP), ax and bx are empty then
+
+	shared_ptr<LevelKeyCache> levels; ///< key reduced to smaller moduli, NULL if key is not a switching key
+
+	/**
+	 * @param[in] ax, bx key
+	 * @param[in] seed seed of ax for sampleUniform2Seeded, NULL if ax is not seeded
+	 */
+	Key(ZZX ax = ZZX::zero(), ZZX bx = ZZX::zero(), const unsigned char* seed = NULL);
+
+	/**
+	 * switching key with residues precomputed in NTT form,
+	 * enough primes are stored for multiplication by polynomials modulo context.q
+	 * @param[in] ax, bx switching key
+	 * @param[in] context context
+	 * @param[in] seed seed of ax for sampleUniform2Seeded, NULL if ax is not seeded
+	 */
+	Key(ZZX ax, ZZX bx, Context& context, const unsigned char* seed = NULL);
+
+	/**
+	 * switching key with residues precomputed in NTT form,
+	 * enough primes are stored for multiplication by polynomials with multBits bits
+	 * @param[in] ax, bx switching key
+	 * @param[in] context context
+	 * @param[in] seed seed of ax for sampleUniform2Seeded, NULL if ax is not seeded
+	 * @param[in] multBits bound on number of bits in coefficients of multiplied polynomials
+	 */
+	Key(ZZX ax, ZZX bx, Context& context, const unsigned char* seed, long multBits);
+
+	/**
+	 * hybrid switching key with dnum digit keys to be filled,
+	 * digit keys together take about (dnum + 1) / 2 times the size of key modulo qq
+	 * @param[in] dnum number of digits
+	 * @param[in] logP log of special modulus
+	 */
+	Key(long dnum, long logP);
+
+	Key(const Key& o) = default;
+
+	/**
+	 * takes polynomials and residues of o without copying them
+	 */
+	Key(Key&& o);
+
+	Key& operator=(const Key& o) = default;
+
+	Key& operator=(Key&& o);
+
+	/**
+	 * drops ax and its residues of seeded key or of seeded digit keys, only seeds and bx are kept,
+	 * residues stay alive while copies of key use them
+	 */
+	void compress();
+
+	/**
+	 * restores ax and its residues of compressed key from seed
+	 * @param[in] context context
+	 */
+	void expand(Context& context);
+
+	/**
+	 * @return true if ax is dropped by compress
+	 */
+	bool isCompressed();
+
+	/**
+	 * @return true if key is hybrid
+	 */
+	bool isHybrid();
+
+	/**
+	 * switching key reduced to the modulus of products with polynomials modulo 2^cbits,
+	 * rounded up to LEVEL_KEY_BITS, so that products need fewer primes or limbs, built on first use and cached
+	 * @param[in] context context
+	 * @param[in] cbits log of modulus of ciphertext
+	 * @return reduced key, empty pointer if key is not smaller at this level or has no ax and bx
+	 */
+	shared_ptr<Key> atLevel(Context& context, long cbits);
+
+private:
+
+	void computeResidues(Context& context, long multBits);
+
+	void expandAx(Context& context, long logMod);
+
+	bool hasPolys(long degree);
+
+	Key reduce(Context& context, long logMod, long multBits);
+
+	/**
+	 * @return array of len words freed with the last key sharing it
+	 */
+	static shared_ptr<uint64_t> allocResidues(long len);
 };
 
 #endif
@@ -0,0 +1,302 @@
+#include "KeyStore.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <stdexcept>
+
+static const uint64_t ENTRY_KEY = 0;
+static const uint64_t ENTRY_LEFTROT = 1;
+static const uint64_t ENTRY_BOOTKEY = 2;
+
+/**
+ * directory of words with residue arrays placed after it
+ */
+struct StoreLayout {
+	vector<uint64_t> words;
+	vector<long> offsetPos; ///< positions in words of offsets of blocks
+	vector<uint64_t*> blocks;
+	vector<long> blockWords;
+
+	void addBlock(uint64_t* block, long nwords) {
+		offsetPos.push_back(words.size());
+		words.push_back(0);
+		blocks.push_back(block);
+		blockWords.push_back(nwords);
+	}
+
+	void addDiagonal(SparsePoly& poly, long logN) {
+		words.push_back(poly.gap);
+		words.push_back(poly.bits);
+		words.push_back(poly.np);
+		addBlock(poly.rx.get(), poly.np << logN);
+	}
+};
+
+static long alignUp(long x) {
+	return (x + KEYSTORE_ALIGN - 1) / KEYSTORE_ALIGN * KEYSTORE_ALIGN;
+}
+
+void KeyStore::write(const string& path, Scheme& scheme) {
+	Context& context = scheme.context;
+	RingMultiplier* multiplier = context.multiplier;
+	if(multiplier == NULL) {
+		throw invalid_argument("key store needs context with RNS backend");
+	}
+
+	StoreLayout layout;
+	layout.words.push_back(KEYSTORE_MAGIC);
+	layout.words.push_back(KEYSTORE_VERSION);
+	layout.words.push_back(context.logN);
+	layout.words.push_back(context.logq);
+	layout.words.push_back(multiplier->maxnp);
+	for (long i = 0; i < multiplier->maxnp; ++i) {
+		layout.words.push_back(multiplier->pVec[i]);
+	}
+	long numPos = layout.words.size();
+	layout.words.push_back(0);
+	long numEntries = 0;
+
+	for (uint64_t type = ENTRY_KEY; type <= ENTRY_LEFTROT; ++type) {
+		map<long, Key>& keys = type == ENTRY_KEY ? scheme.keyMap : scheme.leftRotKeyMap;
+		for (map<long, Key>::iterator it = keys.begin(); it != keys.end(); ++it) {
+			Key& key = it->second;
+			long num = key.isHybrid() ? key.dnum : 1;
+			Key* parts = key.isHybrid() ? key.digits.data() : &key;
+			bool stored = true;
+			for (long i = 0; i < num; ++i) {
+				stored = stored && parts[i].rax && parts[i].rbx;
+			}
+			if(!stored) continue;
+			layout.words.push_back(type);
+			layout.words.push_back(it->first);
+			layout.words.push_back(key.dnum);
+			layout.words.push_back(key.logP);
+			for (long i = 0; i < num; ++i) {
+				layout.words.push_back(parts[i].np);
+				layout.words.push_back(parts[i].bits);
+				layout.addBlock(parts[i].rax.get(), parts[i].np << context.logN);
+				layout.addBlock(parts[i].rbx.get(), parts[i].np << context.logN);
+			}
+			numEntries++;
+		}
+	}
+	for (map<long, BootKey>::iterator it = scheme.bootKeyMap.begin(); it != scheme.bootKeyMap.end(); ++it) {
+		BootKey& bootKey = it->second;
+		layout.words.push_back(ENTRY_BOOTKEY);
+		layout.words.push_back(it->first);
+		layout.words.push_back(bootKey.pBits);
+		layout.words.push_back(bootKey.logSize);
+		layout.words.push_back(bootKey.levels);
+		layout.words.push_back(bootKey.cache != NULL);
+		numEntries++;
+		if(bootKey.cache != NULL) continue;
+		if(bootKey.levels == 0) {
+			long lpow = 1 << bootKey.logSize;
+			for (long j = 0; j < lpow; ++j) {
+				layout.addDiagonal(bootKey.pvec[j], context.logN);
+				layout.addDiagonal(bootKey.pvecInv[j], context.logN);
+			}
+			continue;
+		}
+		for (long i = 0; i < bootKey.levels; ++i) {
+			layout.words.push_back(bootKey.ctsNum[i]);
+			for (long j = 0; j < bootKey.ctsNum[i]; ++j) {
+				layout.words.push_back(bootKey.ctsRot[i][j]);
+				layout.addDiagonal(bootKey.ctsPvec[i][j], context.logN);
+			}
+			layout.words.push_back(bootKey.stcNum[i]);
+			for (long j = 0; j < bootKey.stcNum[i]; ++j) {
+				layout.words.push_back(bootKey.stcRot[i][j]);
+				layout.addDiagonal(bootKey.stcPvec[i][j], context.logN);
+			}
+		}
+	}
+	layout.words[numPos] = numEntries;
+
+	for (size_t b = 0; b < layout.blocks.size(); ++b) {
+		if(layout.blocks[b] == NULL) {
+			throw invalid_argument("key store needs residues of all keys and diagonals");
+		}
+	}
+
+	long offset = alignUp(layout.words.size() * 8);
+	for (size_t b = 0; b < layout.blocks.size(); ++b) {
+		layout.words[layout.offsetPos[b]] = offset;
+		offset = alignUp(offset + layout.blockWords[b] * 8);
+	}
+
+	ofstream out(path.c_str(), ios::binary | ios::trunc);
+	if(!out) {
+		throw runtime_error("cannot open key store " + path);
+	}
+	char zeros[KEYSTORE_ALIGN] = {0};
+	long written = layout.words.size() * 8;
+	out.write((const char*) layout.words.data(), written);
+	for (size_t b = 0; b < layout.blocks.size(); ++b) {
+		long start = layout.words[layout.offsetPos[b]];
+		out.write(zeros, start - written);
+		out.write((const char*) layout.blocks[b], layout.blockWords[b] * 8);
+		written = start + layout.blockWords[b] * 8;
+	}
+	out.write(zeros, alignUp(written) - written);
+	if(!out) {
+		throw runtime_error("cannot write key store " + path);
+	}
+}
+
+KeyStore::KeyStore(const string& path, Context& context) : path(path), data(NULL), size(0), context(context), pos(0) {
+	RingMultiplier* multiplier = context.multiplier;
+	if(multiplier == NULL) {
+		throw invalid_argument("key store needs context with RNS backend");
+	}
+	int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		throw runtime_error("cannot open key store " + path);
+	}
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < 48) {
+		close(fd);
+		throw runtime_error("key store is too short " + path);
+	}
+	size = st.st_size;
+	void* mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) {
+		throw runtime_error("cannot map key store " + path);
+	}
+	data = (unsigned char*) mapped;
+
+	if(next() != KEYSTORE_MAGIC || next() != KEYSTORE_VERSION) {
+		munmap(data, size);
+		throw runtime_error("file is not a key store of this version " + path);
+	}
+	bool matches = (long) next() == context.logN && (long) next() == context.logq && (long) next() == multiplier->maxnp;
+	for (long i = 0; matches && i < multiplier->maxnp; ++i) {
+		matches = next() == multiplier->pVec[i];
+	}
+	if(!matches) {
+		munmap(data, size);
+		throw runtime_error("key store does not match context " + path);
+	}
+}
+
+uint64_t KeyStore::next() {
+	if((pos + 1) * 8 > (long) size) {
+		throw runtime_error("unexpected end of key store " + path);
+	}
+	return ((uint64_t*) data)[pos++];
+}
+
+uint64_t* KeyStore::residues(uint64_t offset, long np) {
+	if(offset % KEYSTORE_ALIGN != 0 || offset + (np << context.logN) * 8 > size) {
+		throw runtime_error("residues out of key store " + path);
+	}
+	return (uint64_t*) (data + offset);
+}
+
+SparsePoly KeyStore::nextDiagonal() {
+	SparsePoly poly;
+	poly.N = context.N;
+	poly.gap = next();
+	poly.bits = next();
+	poly.np = next();
+	if(poly.gap <= 0 || context.N % poly.gap != 0) {
+		throw runtime_error("diagonal does not match context in key store " + path);
+	}
+	poly.num = context.N / poly.gap;
+	poly.rx = shared_ptr<uint64_t>(shared_ptr<uint64_t>(), residues(next(), poly.np));
+	return poly;
+}
+
+void KeyStore::load(Scheme& scheme) {
+	pos = 5 + context.multiplier->maxnp;
+	long numEntries = next();
+	bool lazy = false;
+	for (long e = 0; e < numEntries; ++e) {
+		uint64_t type = next();
+		long idx = next();
+		if(type == ENTRY_KEY || type == ENTRY_LEFTROT) {
+			long dnum = next();
+			long logP = next();
+			Key key = dnum > 0 ? Key(dnum, logP) : Key();
+			long num = key.isHybrid() ? key.dnum : 1;
+			Key* parts = key.isHybrid() ? key.digits.data() : &key;
+			for (long i = 0; i < num; ++i) {
+				parts[i].np = next();
+				parts[i].bits = next();
+				parts[i].rax = shared_ptr<uint64_t>(shared_ptr<uint64_t>(), residues(next(), parts[i].np));
+				parts[i].rbx = shared_ptr<uint64_t>(shared_ptr<uint64_t>(), residues(next(), parts[i].np));
+			}
+			map<long, Key>& keys = type == ENTRY_KEY ? scheme.keyMap : scheme.leftRotKeyMap;
+			keys.erase(idx);
+			keys.insert(pair<long, Key>(idx, key));
+		} else if(type == ENTRY_BOOTKEY) {
+			long pBits = next();
+			long logSize = next();
+			long levels = next();
+			bool isLazy = next() != 0;
+			if(logSize < 0 || logSize >= context.logN || levels < 0 || levels > logSize) {
+				throw runtime_error("BootKey does not match context in key store " + path);
+			}
+			BootKey bootKey;
+			if(isLazy) {
+				bootKey = BootKey(context, pBits, logSize, &scheme.diagonalCache);
+				lazy = true;
+			} else {
+				bootKey.pBits = pBits;
+				bootKey.logSize = logSize;
+				bootKey.levels = levels;
+				if(levels == 0) {
+					long lpow = 1 << logSize;
+					bootKey.pvec.resize(lpow);
+					bootKey.pvecInv.resize(lpow);
+					for (long j = 0; j < lpow; ++j) {
+						bootKey.pvec[j] = nextDiagonal();
+						bootKey.pvecInv[j] = nextDiagonal();
+					}
+				} else {
+					bootKey.ctsNum.resize(levels);
+					bootKey.ctsRot.resize(levels);
+					bootKey.ctsPvec.resize(levels);
+					bootKey.stcNum.resize(levels);
+					bootKey.stcRot.resize(levels);
+					bootKey.stcPvec.resize(levels);
+					for (long i = 0; i < levels; ++i) {
+						for (long s = 0; s < 2; ++s) {
+							long num = next();
+							if(num < 0 || num > (1L << logSize)) {
+								throw runtime_error("BootKey does not match context in key store " + path);
+							}
+							vector<long> rot(num);
+							vector<SparsePoly> pvec(num);
+							for (long j = 0; j < num; ++j) {
+								rot[j] = next();
+								pvec[j] = nextDiagonal();
+							}
+							(s == 0 ? bootKey.ctsNum : bootKey.stcNum)[i] = num;
+							(s == 0 ? bootKey.ctsRot : bootKey.stcRot)[i] = rot;
+							(s == 0 ? bootKey.ctsPvec : bootKey.stcPvec)[i] = pvec;
+						}
+					}
+				}
+			}
+			scheme.bootKeyMap.erase(idx);
+			scheme.bootKeyMap.insert(pair<long, BootKey>(idx, bootKey));
+		} else {
+			throw runtime_error("unknown entry in key store " + path);
+		}
+	}
+	if(lazy) {
+		scheme.diagonalCache.clear();
+	}
+}
+
+KeyStore::~KeyStore() {
+	if(data != NULL) {
+		munmap(data, size);
+	}
+}
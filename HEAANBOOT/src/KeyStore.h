@@ -0,0 +1,66 @@
+#ifndef HEAAN_KEYSTORE_H_
+#define HEAAN_KEYSTORE_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "Scheme.h"
+
+using namespace std;
+
+static const uint64_t KEYSTORE_MAGIC = 0x5359454B4E414548; ///< "HEANKEYS" in little-endian bytes
+static const uint64_t KEYSTORE_VERSION = 2;
+static const long KEYSTORE_ALIGN = 64; ///< alignment of residue arrays in file
+
+/**
+ * Read-only store of evaluation keys in a memory-mapped file.
+ * The file keeps residues in NTT form of switching keys and BootKey diagonals as the RNS backend uses them,
+ * loaded keys point into the mapping, so processes mapping the same file share one copy in the page cache.
+ * Loaded keys have no ax and bx, so they need Context with BACKEND_RNS and the same logN and logq.
+ * Files use the byte order of the host that writes them
+ */
+class KeyStore {
+public:
+
+	string path;
+	unsigned char* data; ///< mapped file
+	size_t size; ///< size of mapped file
+
+	/**
+	 * maps file read-only, throws runtime_error if it is not a key store for context
+	 * @param[in] path path of file written by write
+	 * @param[in] context context with RNS backend
+	 */
+	KeyStore(const string& path, Context& context);
+
+	/**
+	 * writes residues of keys of keyMap and leftRotKeyMap that have them and of all BootKeys of scheme,
+	 * lazy BootKeys are written without diagonals
+	 * @param[in] path path of file
+	 * @param[in] scheme scheme with context with RNS backend
+	 */
+	static void write(const string& path, Scheme& scheme);
+
+	/**
+	 * puts keys of store into key maps of scheme, replacing keys with the same index,
+	 * the store should outlive scheme
+	 * @param[in, out] scheme scheme with context of store
+	 */
+	void load(Scheme& scheme);
+
+	virtual ~KeyStore();
+
+private:
+
+	Context& context;
+	long pos; ///< position in directory while loading
+
+	uint64_t next();
+
+	uint64_t* residues(uint64_t offset, long np);
+
+	SparsePoly nextDiagonal();
+};
+
+#endif
@@ -0,0 +1,24 @@
+#include "LevelKeyCache.h"
+
+#include "Key.h"
+
+shared_ptr<Key> LevelKeyCache::find(long logMod) {
+	lock_guard<mutex> guard(lock);
+	map<long, shared_ptr<Key> >::iterator it = keys.find(logMod);
+	return it == keys.end() ? shared_ptr<Key>() : it->second;
+}
+
+shared_ptr<Key> LevelKeyCache::insert(long logMod, shared_ptr<Key> key) {
+	lock_guard<mutex> guard(lock);
+	return keys.insert(make_pair(logMod, key)).first->second;
+}
+
+long LevelKeyCache::size() {
+	lock_guard<mutex> guard(lock);
+	return keys.size();
+}
+
+void LevelKeyCache::clear() {
+	lock_guard<mutex> guard(lock);
+	keys.clear();
+}
@@ -0,0 +1,49 @@
+#ifndef HEAAN_LEVELKEYCACHE_H_
+#define HEAAN_LEVELKEYCACHE_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+class Key;
+
+static const long LEVEL_KEY_BITS = 64; ///< moduli of level keys are rounded up to multiples of this number of bits
+
+/**
+ * Switching key reduced to smaller moduli, one key per modulus, built on first use.
+ * Copies of a key share its cache.
+ * Methods are safe to call from concurrent tasks
+ */
+class LevelKeyCache {
+public:
+
+	/**
+	 * @param[in] logMod log of modulus of reduced key
+	 * @return cached key, empty pointer if it is not cached
+	 */
+	shared_ptr<Key> find(long logMod);
+
+	/**
+	 * caches key unless a key for the same modulus is already cached
+	 * @param[in] logMod log of modulus of reduced key
+	 * @param[in] key reduced key
+	 * @return cached key for logMod
+	 */
+	shared_ptr<Key> insert(long logMod, shared_ptr<Key> key);
+
+	/**
+	 * @return number of cached keys
+	 */
+	long size();
+
+	void clear();
+
+private:
+
+	map<long, shared_ptr<Key> > keys;
+	mutex lock;
+};
+
+#endif
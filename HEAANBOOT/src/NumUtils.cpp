@@ -70,6 +70,23 @@ void NumUtils::sampleUniform2(ZZX& res, const long& size, const long& logBnd) {
 	}
 }
 
+void NumUtils::sampleSeed(unsigned char* seed) {
+	BytesFromZZ(seed, RandomBits_ZZ(8 * SEED_BYTES), SEED_BYTES);
+}
+
+void NumUtils::sampleUniform2Seeded(ZZX& res, const long& size, const long& logBnd, const unsigned char* seed) {
+	RandomStream stream(seed);
+	long nbytes = (logBnd + 7) / 8;
+	unsigned char* buf = new unsigned char[nbytes];
+	res.SetLength(size);
+	for (long i = 0; i < size; i++) {
+		stream.get(buf, nbytes);
+		ZZFromBytes(res.rep[i], buf, nbytes);
+		trunc(res.rep[i], res.rep[i], logBnd);
+	}
+	delete[] buf;
+}
+
 void NumUtils::fftRaw(CZZ*& vals, const long& size, const RR* ksiPowsr, const RR* ksiPowsi, const long& M, const bool& isForward) {
 	for (long i = 1, j = 0; i < size; ++i) {
 		long bit = size >> 1;
@@ -175,3 +192,90 @@ void NumUtils::fftSpecialInv(CZZ*& vals, const long& size, const RR* ksiPowsr, c
 		vals[i] /= size;
 	}
 }
+
+//-----------------------------------------
+
+template<typename T>
+static void fftRawT(complex<T>* vals, const long& size, const complex<T>* ksiPows, const long& M, const bool& isForward) {
+	for (long i = 1, j = 0; i < size; ++i) {
+		long bit = size >> 1;
+		for (; j >= bit; bit>>=1) {
+			j -= bit;
+		}
+		j += bit;
+		if(i < j) {
+			swap(vals[i], vals[j]);
+		}
+	}
+	for (long len = 2; len <= size; len <<= 1) {
+		long MoverLen = M / len;
+		for (long i = 0; i < size; i += len) {
+			for (long j = 0; j < len / 2; ++j) {
+				complex<T> u = vals[i + j];
+				complex<T> v = vals[i + j + len / 2] * ksiPows[(isForward ? j : len - j) * MoverLen];
+				vals[i + j] = u + v;
+				vals[i + j + len / 2] = u - v;
+			}
+		}
+	}
+}
+
+template<typename T>
+static void fftSpecialT(complex<T>* vals, const long& size, const complex<T>* ksiPows, const long& M) {
+	for (long i = 1, j = 0; i < size; ++i) {
+		long bit = size >> 1;
+		for (; j >= bit; bit>>=1) {
+			j -= bit;
+		}
+		j += bit;
+		if(i < j) {
+			swap(vals[i], vals[j]);
+		}
+	}
+	for (long len = 2; len <= size; len <<= 1) {
+		long Mover2Len = M / len / 2;
+		for (long i = 0; i < size; i += len) {
+			for (long j = 0; j < len / 2; ++j) {
+				complex<T> u = vals[i + j];
+				complex<T> v = vals[i + j + len / 2] * ksiPows[(2 * j + 1) * Mover2Len];
+				vals[i + j] = u + v;
+				vals[i + j + len / 2] = u - v;
+			}
+		}
+	}
+}
+
+template<typename T>
+static void fftSpecialInvT(complex<T>* vals, const long& size, const complex<T>* ksiPows, const long& M) {
+	fftRawT(vals, size, ksiPows, M, false);
+	long doublesize = size << 1;
+	long Mover2size = M / doublesize;
+	for (long i = 0; i < size; ++i) {
+		vals[i] *= ksiPows[(doublesize - i) * Mover2size];
+		vals[i] /= (T) size;
+	}
+}
+
+void NumUtils::fftRaw(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M, const bool& isForward) {
+	fftRawT(vals, size, ksiPows, M, isForward);
+}
+
+void NumUtils::fftRaw(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M, const bool& isForward) {
+	fftRawT(vals, size, ksiPows, M, isForward);
+}
+
+void NumUtils::fftSpecial(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M) {
+	fftSpecialT(vals, size, ksiPows, M);
+}
+
+void NumUtils::fftSpecial(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M) {
+	fftSpecialT(vals, size, ksiPows, M);
+}
+
+void NumUtils::fftSpecialInv(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M) {
+	fftSpecialInvT(vals, size, ksiPows, M);
+}
+
+void NumUtils::fftSpecialInv(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M) {
+	fftSpecialInvT(vals, size, ksiPows, M);
+}
@@ -6,9 +6,13 @@
 #include <NTL/ZZ.h>
 #include "CZZ.h"
 
+#include <complex>
+
 #include "Common.h"
 using namespace NTL;
 
+static const long SEED_BYTES = NTL_PRG_KEYLEN; ///< size of seeds of uniform polynomials
+
 class NumUtils {
 public:
 
@@ -60,6 +64,22 @@ public:
 	 */
 	static void sampleUniform2(ZZX& res, const long& size, const long& logBnd);
 
+	/**
+	 * samples seed of SEED_BYTES bytes for sampleUniform2Seeded
+	 * @param[out] seed array of SEED_BYTES bytes
+	 */
+	static void sampleSeed(unsigned char* seed);
+
+	/**
+	 * expands seed into polynomial with uniform coefficients in [0, 2^logBnd-1] with NTL RandomStream (ChaCha20),
+	 * the same seed always gives the same polynomial
+	 * @param[out] ZZX polynomial
+	 * @param[in] long polynomial degree
+	 * @param[in] long log(bound)
+	 * @param[in] seed array of SEED_BYTES bytes
+	 */
+	static void sampleUniform2Seeded(ZZX& res, const long& size, const long& logBnd, const unsigned char* seed);
+
 	//-----------------------------------------
 
 	/**
@@ -120,6 +140,42 @@ public:
 	static void fftSpecialInv(CZZ*& vals, const long& size, const RR* ksiPowsr, const RR* ksiPowsi, const long& M);
 
 	//-----------------------------------------
+
+	/**
+	 * calculates pre fft in double precision
+	 * @param[in, out] arrays of vals
+	 * @param[in] size of array
+	 * @param[in] powers of 2M-th root of unity
+	 * @param[in] M
+	 * @param[in] direction
+	 */
+	static void fftRaw(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M, const bool& isForward);
+
+	static void fftRaw(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M, const bool& isForward);
+
+	/**
+	 * calculates special fft in double precision needed for decoding
+	 * @param[in, out] arrays of vals
+	 * @param[in] size of array
+	 * @param[in] powers of 2M-th root of unity
+	 * @param[in] M
+	 */
+	static void fftSpecial(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M);
+
+	static void fftSpecial(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M);
+
+	/**
+	 * calculates special fft inverse in double precision needed for encoding
+	 * @param[in, out] arrays of vals
+	 * @param[in] size of array
+	 * @param[in] powers of 2M-th root of unity
+	 * @param[in] M
+	 */
+	static void fftSpecialInv(complex<double>* vals, const long& size, const complex<double>* ksiPows, const long& M);
+
+	static void fftSpecialInv(complex<long double>* vals, const long& size, const complex<long double>* ksiPows, const long& M);
+
+	//-----------------------------------------
 };
 
 #endif
@@ -0,0 +1,52 @@
+#include "PackedCiphertext.h"
+
+#include <cstring>
+
+PackedCiphertext::PackedCiphertext(long N, long cbits, long slots, bool isComplex) : N(N), cbits(cbits), slots(slots), isComplex(isComplex) {
+	limbs = numLimbs(cbits);
+	ax = allocLimbs(N * limbs);
+	bx = allocLimbs(N * limbs);
+}
+
+PackedCiphertext::PackedCiphertext(const PackedCiphertext& o) : N(o.N), limbs(o.limbs), cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {
+	ax = allocLimbs(N * limbs);
+	bx = allocLimbs(N * limbs);
+	memcpy(ax, o.ax, N * limbs * sizeof(uint64_t));
+	memcpy(bx, o.bx, N * limbs * sizeof(uint64_t));
+}
+
+PackedCiphertext& PackedCiphertext::operator=(const PackedCiphertext& o) {
+	if(this != &o) {
+		free(ax);
+		free(bx);
+		N = o.N;
+		limbs = o.limbs;
+		cbits = o.cbits;
+		slots = o.slots;
+		isComplex = o.isComplex;
+		ax = allocLimbs(N * limbs);
+		bx = allocLimbs(N * limbs);
+		memcpy(ax, o.ax, N * limbs * sizeof(uint64_t));
+		memcpy(bx, o.bx, N * limbs * sizeof(uint64_t));
+	}
+	return *this;
+}
+
+long PackedCiphertext::numLimbs(const long& bits) {
+	return (bits + 63) / 64;
+}
+
+uint64_t* PackedCiphertext::allocLimbs(const long& size) {
+	void* res = NULL;
+	long bytes = ((size * sizeof(uint64_t) + 63) / 64) * 64;
+	if(posix_memalign(&res, 64, bytes > 0 ? bytes : 64) != 0) {
+		throw bad_alloc();
+	}
+	memset(res, 0, bytes);
+	return (uint64_t*) res;
+}
+
+PackedCiphertext::~PackedCiphertext() {
+	free(ax);
+	free(bx);
+}
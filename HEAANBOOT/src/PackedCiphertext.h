@@ -0,0 +1,55 @@
+#ifndef HEAAN_PACKEDCIPHERTEXT_H_
+#define HEAAN_PACKEDCIPHERTEXT_H_
+
+#include <stdint.h>
+
+#include "Common.h"
+
+using namespace std;
+
+/**
+ * Cipher (ax, bx) with coefficients in Z_q for q = 2^cbits stored as 64-bit words,
+ * each polynomial is one contiguous 64-byte aligned array with coefficients one after another:
+ * ax[j * limbs + k] is the k-th least significant word of the j-th coefficient of ax
+ */
+class PackedCiphertext {
+public:
+
+	uint64_t* ax;
+	uint64_t* bx;
+
+	long N; ///< number of coefficients
+	long limbs; ///< words per coefficient
+	long cbits; ///< bits in cipher
+	long slots; ///< number of slots
+
+	bool isComplex;
+
+	//-----------------------------------------
+
+	/**
+	 * allocates zero cipher
+	 * @param[in] N: number of coefficients
+	 * @param[in] cbits: bits in cipher
+	 * @param[in] slots: number of slots
+	 */
+	PackedCiphertext(long N = 0, long cbits = 0, long slots = 1, bool isComplex = true);
+
+	PackedCiphertext(const PackedCiphertext& o);
+
+	PackedCiphertext& operator=(const PackedCiphertext& o);
+
+	/**
+	 * @return number of 64-bit words for bits
+	 */
+	static long numLimbs(const long& bits);
+
+	/**
+	 * @return 64-byte aligned zero array of size words
+	 */
+	static uint64_t* allocLimbs(const long& size);
+
+	virtual ~PackedCiphertext();
+};
+
+#endif
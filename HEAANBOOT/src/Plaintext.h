@@ -25,9 +25,31 @@ public:
 	 * @param[in] bits: bits in cipher
 	 * @param[in] slots: number of slots
 	 */
-	Plaintext(ZZX mx = ZZX::zero(), ZZ mod = ZZ::zero(), long cbits = 0, long slots = 1, bool isComplex = true) : mx(mx), mod(mod), cbits(cbits), slots(slots), isComplex(isComplex) {}
+	Plaintext(ZZX mx = ZZX::zero(), ZZ mod = ZZ::zero(), long cbits = 0, long slots = 1, bool isComplex = true) : cbits(cbits), slots(slots), isComplex(isComplex) {
+		swap(this->mx, mx);
+		swap(this->mod, mod);
+	}
 
 	Plaintext(const Plaintext& o) : mx(o.mx), mod(o.mod), cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {}
+
+	/**
+	 * takes polynomial of o without copying it, o is left empty
+	 */
+	Plaintext(Plaintext&& o) : cbits(o.cbits), slots(o.slots), isComplex(o.isComplex) {
+		swap(mx, o.mx);
+		swap(mod, o.mod);
+	}
+
+	Plaintext& operator=(const Plaintext& o) = default;
+
+	Plaintext& operator=(Plaintext&& o) {
+		swap(mx, o.mx);
+		swap(mod, o.mod);
+		cbits = o.cbits;
+		slots = o.slots;
+		isComplex = o.isComplex;
+		return *this;
+	}
 };
 
 #endif
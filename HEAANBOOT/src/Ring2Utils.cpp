@@ -1,11 +1,11 @@
 #include "Ring2Utils.h"
 
-//-----------------------------------------
+#include <stdexcept>
 
 void Ring2Utils::mod(ZZX& res, ZZX& p, ZZ& mod, const long& degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		res.rep[i] = p.rep[i] % mod;
+		rem(res.rep[i], p.rep[i], mod);
 	}
 }
 
@@ -49,7 +49,8 @@ void Ring2Utils::addAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 void Ring2Utils::sub(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		AddMod(res.rep[i], p1.rep[i], -p2.rep[i], mod);
+		NTL::sub(res.rep[i], p1.rep[i], p2.rep[i]);
+		if(res.rep[i] >= mod) res.rep[i] -= mod;
 	}
 }
 
@@ -66,13 +67,15 @@ ZZX Ring2Utils::sub(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 
 void Ring2Utils::subAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 	for (long i = 0; i < degree; ++i) {
-		AddMod(p1.rep[i], p1.rep[i], -p2.rep[i], mod);
+		NTL::sub(p1.rep[i], p1.rep[i], p2.rep[i]);
+		if(p1.rep[i] >= mod) p1.rep[i] -= mod;
 	}
 }
 
 void Ring2Utils::subAndEqual2(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 	for (long i = 0; i < degree; ++i) {
-		AddMod(p2.rep[i], p1.rep[i], -p2.rep[i], mod);
+		NTL::sub(p2.rep[i], p1.rep[i], p2.rep[i]);
+		if(p2.rep[i] >= mod) p2.rep[i] -= mod;
 	}
 }
 
@@ -80,7 +83,7 @@ void Ring2Utils::conjugate(ZZX& res, ZZX& p, const long& degree) {
 	res.SetLength(degree);
 	res.rep[0] = p.rep[0];
 	for (long i = 1; i < degree; ++i) {
-		res.rep[i] = -p.rep[degree - i];
+		NTL::negate(res.rep[i], p.rep[degree - i]);
 	}
 }
 
@@ -100,9 +103,11 @@ void Ring2Utils::conjugateAndEqual(ZZX& p, const long& degree) {
 
 //-----------------------------------------
 
-void Ring2Utils::mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
+void Ring2Utils::mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && multiplier->N == degree && multiplier->mult(res, p1, p2, mod)) return;
 	res.SetLength(degree);
-	ZZX p;
+	ScratchArena::Frame frame;
+	ZZX& p = frame.poly();
 	mul(p, p1, p2);
 	p.SetLength(2 * degree);
 	for (long i = 0; i < degree; ++i) {
@@ -112,9 +117,9 @@ void Ring2Utils::mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 	}
 }
 
-ZZX Ring2Utils::mult(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
+ZZX Ring2Utils::mult(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
 	ZZX res;
-	mult(res, p1, p2, mod, degree);
+	mult(res, p1, p2, mod, degree, multiplier);
 	return res;
 }
 
@@ -138,8 +143,10 @@ ZZX Ring2Utils::mult(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 //	mult(res.ix, p1.ix, p2, mod, degree);
 //}
 
-void Ring2Utils::multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
-	ZZX p;
+void Ring2Utils::multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && multiplier->N == degree && multiplier->mult(p1, p1, p2, mod)) return;
+	ScratchArena::Frame frame;
+	ZZX& p = frame.poly();
 	mul(p, p1, p2);
 	p.SetLength(2 * degree);
 
@@ -173,9 +180,11 @@ void Ring2Utils::multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree) {
 
 //-----------------------------------------
 
-void Ring2Utils::square(ZZX& res, ZZX& p, ZZ& mod, const long& degree) {
+void Ring2Utils::square(ZZX& res, ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && multiplier->N == degree && multiplier->square(res, p, mod)) return;
 	res.SetLength(degree);
-	ZZX pp;
+	ScratchArena::Frame frame;
+	ZZX& pp = frame.poly();
 	sqr(pp, p);
 	pp.SetLength(2 * degree);
 
@@ -186,9 +195,9 @@ void Ring2Utils::square(ZZX& res, ZZX& p, ZZ& mod, const long& degree) {
 	}
 }
 
-ZZX Ring2Utils::square(ZZX& p, ZZ& mod, const long& degree) {
+ZZX Ring2Utils::square(ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
 	ZZX res;
-	square(res, p, mod, degree);
+	square(res, p, mod, degree, multiplier);
 	return res;
 }
 
@@ -202,8 +211,10 @@ ZZX Ring2Utils::square(ZZX& p, ZZ& mod, const long& degree) {
 //	add(res.ix, tmp2, tmp2, mod, degree);
 //}
 
-void Ring2Utils::squareAndEqual(ZZX& p, ZZ& mod, const long& degree) {
-	ZZX pp;
+void Ring2Utils::squareAndEqual(ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && multiplier->N == degree && multiplier->square(p, p, mod)) return;
+	ScratchArena::Frame frame;
+	ZZX& pp = frame.poly();
 	sqr(pp, p);
 	pp.SetLength(2 * degree);
 
@@ -225,6 +236,62 @@ void Ring2Utils::squareAndEqual(ZZX& p, ZZ& mod, const long& degree) {
 //	addAndEqual(p.ix, p.ix, mod, degree);
 //}
 
+void Ring2Utils::multByKey(ZZX& resa, ZZX& resb, ZZX& p, Key& key, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && key.rax && multiplier->N == degree
+			&& multiplier->multNTT(resa, resb, p, key.rax.get(), key.rbx.get(), key.bits, key.np, mod)) return;
+	if(key.ax.rep.length() == 0 || key.bx.rep.length() == 0) {
+		throw invalid_argument("key without ax or bx needs RNS residues for this product");
+	}
+	ScratchArena::Frame frame;
+	ZZX& pp = frame.poly();
+	pp = p;
+	NTL_EXEC_RANGE(2, first, last);
+	for (long index = first; index < last; ++index) {
+		if(index == 0) {
+			mult(resa, pp, key.ax, mod, degree, multiplier);
+		} else {
+			mult(resb, pp, key.bx, mod, degree, multiplier);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void Ring2Utils::multBySparse(ZZX& res, ZZX& p, SparsePoly& s, ZZ& mod, const long& degree, RingMultiplier* multiplier) {
+	if(multiplier != NULL && s.rx && multiplier->N == degree
+			&& multiplier->multNTT(res, p, s.rx.get(), s.bits, s.np, mod)) return;
+	if(!s.coeffs) {
+		throw invalid_argument("sparse polynomial without coefficients needs RNS residues for this product");
+	}
+	ScratchArena::Frame frame;
+	if(s.num > SPARSE_DIRECT_NUM) {
+		ZZX& sx = frame.poly();
+		s.expand(sx);
+		mult(res, p, sx, mod, degree, multiplier);
+		return;
+	}
+	ZZX& pp = frame.poly();
+	pp = p;
+	pp.SetLength(degree);
+	res.SetLength(degree);
+	ZZ* coeffs = s.coeffs.get();
+	NTL_EXEC_RANGE(degree, first, last);
+	ScratchArena::Frame workerFrame;
+	ZZ& tmp = workerFrame.number();
+	for (long k = first; k < last; ++k) {
+		clear(tmp);
+		for (long i = 0; i < s.num; ++i) {
+			long j = k - i * s.gap;
+			if(j >= 0) {
+				MulAddTo(tmp, pp.rep[j], coeffs[i]);
+			} else {
+				MulSubFrom(tmp, pp.rep[j + degree], coeffs[i]);
+			}
+		}
+		rem(res.rep[k], tmp, mod);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
 //-----------------------------------------
 
 void Ring2Utils::multByMonomial(ZZX& res, ZZX& p, const long& monomialDeg, const long& degree) {
@@ -232,19 +299,29 @@ void Ring2Utils::multByMonomial(ZZX& res, ZZX& p, const long& monomialDeg, const
 	if(shift == 0) {
 		res = p;
 	} else {
-		ZZX tmpx;
+		ScratchArena::Frame frame;
+		ZZX& tmpx = frame.poly();
+		tmpx = p;
 		tmpx.SetLength(degree);
-		tmpx = (shift < degree) ? p : -p;
+		bool neg = shift >= degree;
 		shift %= degree;
 
 		res.SetLength(degree);
 
 		for (long i = 0; i < shift; ++i) {
-			res.rep[i] = -tmpx.rep[degree - shift + i];
+			if(neg) {
+				res.rep[i] = tmpx.rep[degree - shift + i];
+			} else {
+				NTL::negate(res.rep[i], tmpx.rep[degree - shift + i]);
+			}
 		}
 
 		for (long i = shift; i < degree; ++i) {
-			res.rep[i] = tmpx.rep[i - shift];
+			if(neg) {
+				NTL::negate(res.rep[i], tmpx.rep[i - shift]);
+			} else {
+				res.rep[i] = tmpx.rep[i - shift];
+			}
 		}
 	}
 }
@@ -265,16 +342,26 @@ void Ring2Utils::multByMonomialAndEqual(ZZX& p, const long& monomialDeg, const l
 	if(shift == 0) {
 		return;
 	}
-	ZZX tmpx;
+	ScratchArena::Frame frame;
+	ZZX& tmpx = frame.poly();
+	tmpx = p;
 	tmpx.SetLength(degree);
-	tmpx = (shift < degree) ? p : -p;
+	bool neg = shift >= degree;
 	shift %= degree;
 	for (long i = 0; i < shift; ++i) {
-		p.rep[i] = -tmpx.rep[degree - shift + i];
+		if(neg) {
+			p.rep[i] = tmpx.rep[degree - shift + i];
+		} else {
+			NTL::negate(p.rep[i], tmpx.rep[degree - shift + i]);
+		}
 	}
 
 	for (long i = shift; i < degree; ++i) {
-		p.rep[i] = tmpx.rep[i - shift];
+		if(neg) {
+			NTL::negate(p.rep[i], tmpx.rep[i - shift]);
+		} else {
+			p.rep[i] = tmpx.rep[i - shift];
+		}
 	}
 }
 
@@ -351,7 +438,7 @@ void Ring2Utils::multByConstAndEqual(ZZX& p, const ZZ& cnst, ZZ& mod, const long
 void Ring2Utils::leftShift(ZZX& res, ZZX& p, const long& bits, ZZ& mod, const long& degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		res.rep[i] = p.rep[i] << bits;
+		LeftShift(res.rep[i], p.rep[i], bits);
 		res.rep[i] %= mod;
 	}
 }
@@ -385,7 +472,7 @@ void Ring2Utils::doubleAndEqual(ZZX& p, ZZ& mod, const long& degree) {
 void Ring2Utils::rightShift(ZZX& res, ZZX& p, const long& bits, const long& degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		res.rep[i] = p.rep[i] >> bits;
+		RightShift(res.rep[i], p.rep[i], bits);
 	}
 }
 
@@ -400,6 +487,34 @@ void Ring2Utils::rightShiftAndEqual(ZZX& p, const long& bits, const long& degree
 	}
 }
 
+void Ring2Utils::rightShiftRound(ZZX& res, ZZX& p, const long& bits, const long& degree) {
+	res.SetLength(degree);
+	for (long i = 0; i < degree; ++i) {
+		res.rep[i] = p.rep[i];
+	}
+	rightShiftRoundAndEqual(res, bits, degree);
+}
+
+void Ring2Utils::rightShiftRoundAndEqual(ZZX& p, const long& bits, const long& degree) {
+	if(bits <= 0) return;
+	ZZ half = power2_ZZ(bits - 1);
+	for (long i = 0; i < degree; ++i) {
+		rightShiftRound(p.rep[i], half, bits);
+	}
+}
+
+void Ring2Utils::rightShiftRound(ZZ& x, const ZZ& half, const long& bits) {
+	if(sign(x) < 0) {
+		NTL::negate(x, x);
+		x += half;
+		x >>= bits;
+		NTL::negate(x, x);
+	} else {
+		x += half;
+		x >>= bits;
+	}
+}
+
 //void Ring2Utils::rightShiftAndEqual(CZZX& p, const long& bits, const long& logMod, const long& degree) {
 //	rightShiftAndEqual(p.rx, bits, logMod, degree);
 //	rightShiftAndEqual(p.ix, bits, logMod, degree);
@@ -410,13 +525,14 @@ void Ring2Utils::rightShiftAndEqual(ZZX& p, const long& bits, const long& degree
 void Ring2Utils::inpower(ZZX& res, ZZX& p, const long& pow, ZZ& mod, const long& degree) {
 	res.SetLength(degree);
 	for (long i = 0; i < degree; ++i) {
-		long ipow = i * pow;
-		long shift = ipow % (2 * degree);
+		long shift = (i * pow) % (2 * degree);
+		ZZ& r = res.rep[shift % degree];
 		if(shift < degree) {
-			AddMod(res.rep[shift % degree], res.rep[shift % degree], p.rep[i], mod);
+			r = p.rep[i];
 		} else {
-			AddMod(res.rep[shift % degree], res.rep[shift % degree], -p.rep[i], mod);
+			NTL::negate(r, p.rep[i]);
 		}
+		if(r >= mod) r -= mod;
 	}
 }
 
@@ -449,3 +565,113 @@ ZZX Ring2Utils::innerProduct(ZZX*& pvec1, ZZX*& pvec2, const long& size, ZZ& mod
 	}
 	return res;
 }
+
+//-----------------------------------------
+
+void Ring2Utils::toLimbs(uint64_t* res, ZZX& p, const long& bits, const long& degree) {
+	long limbs = (bits + 63) / 64;
+	ZZ mod = power2_ZZ(bits);
+	ZZ c;
+	unsigned char* bytes = new unsigned char[limbs * 8];
+	for (long j = 0; j < degree; ++j) {
+		c = coeff(p, j);
+		if(sign(c) < 0 || NumBits(c) > bits) {
+			c %= mod;
+		}
+		BytesFromZZ(bytes, c, limbs * 8);
+		uint64_t* resj = res + j * limbs;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t word = 0;
+			for (long b = 7; b >= 0; --b) {
+				word = (word << 8) | bytes[k * 8 + b];
+			}
+			resj[k] = word;
+		}
+	}
+	delete[] bytes;
+}
+
+void Ring2Utils::fromLimbs(ZZX& res, uint64_t* p, const long& limbs, const long& degree) {
+	unsigned char* bytes = new unsigned char[limbs * 8];
+	res.SetLength(degree);
+	for (long j = 0; j < degree; ++j) {
+		uint64_t* pj = p + j * limbs;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t word = pj[k];
+			for (long b = 0; b < 8; ++b) {
+				bytes[k * 8 + b] = (unsigned char) word;
+				word >>= 8;
+			}
+		}
+		ZZFromBytes(res.rep[j], bytes, limbs * 8);
+	}
+	delete[] bytes;
+}
+
+void Ring2Utils::addLimbsAndEqual(uint64_t* p1, uint64_t* p2, const long& bits, const long& degree) {
+	long limbs = (bits + 63) / 64;
+	uint64_t mask = (bits % 64) ? (((uint64_t) 1 << (bits % 64)) - 1) : ~(uint64_t) 0;
+	for (long j = 0; j < degree; ++j) {
+		uint64_t* x = p1 + j * limbs;
+		uint64_t* y = p2 + j * limbs;
+		uint64_t carry = 0;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t s = x[k] + carry;
+			carry = s < carry;
+			x[k] = s + y[k];
+			carry += x[k] < s;
+		}
+		x[limbs - 1] &= mask;
+	}
+}
+
+void Ring2Utils::subLimbsAndEqual(uint64_t* p1, uint64_t* p2, const long& bits, const long& degree) {
+	long limbs = (bits + 63) / 64;
+	uint64_t mask = (bits % 64) ? (((uint64_t) 1 << (bits % 64)) - 1) : ~(uint64_t) 0;
+	for (long j = 0; j < degree; ++j) {
+		uint64_t* x = p1 + j * limbs;
+		uint64_t* y = p2 + j * limbs;
+		uint64_t borrow = 0;
+		for (long k = 0; k < limbs; ++k) {
+			uint64_t d = x[k] - borrow;
+			borrow = x[k] < borrow;
+			borrow += d < y[k];
+			x[k] = d - y[k];
+		}
+		x[limbs - 1] &= mask;
+	}
+}
+
+void Ring2Utils::rightShiftLimbsAndEqual(uint64_t* p, const long& bits, const long& shift, const long& degree) {
+	long limbs = (bits + 63) / 64;
+	long newlimbs = (bits - shift + 63) / 64;
+	long w = shift / 64;
+	long r = shift % 64;
+	for (long j = 0; j < degree; ++j) {
+		uint64_t* src = p + j * limbs;
+		uint64_t* dst = p + j * newlimbs;
+		for (long k = 0; k < newlimbs; ++k) {
+			uint64_t lo = src[k + w];
+			uint64_t hi = (k + w + 1 < limbs) ? src[k + w + 1] : 0;
+			dst[k] = r ? ((lo >> r) | (hi << (64 - r))) : lo;
+		}
+	}
+}
+
+void Ring2Utils::rightShiftRoundLimbsAndEqual(uint64_t* p, const long& bits, const long& shift, const long& degree) {
+	if(shift <= 0) return;
+	long limbs = (bits + 63) / 64;
+	long w = (shift - 1) / 64;
+	uint64_t half = (uint64_t) 1 << ((shift - 1) % 64);
+	uint64_t mask = (bits % 64) ? (((uint64_t) 1 << (bits % 64)) - 1) : ~(uint64_t) 0;
+	for (long j = 0; j < degree; ++j) {
+		uint64_t* x = p + j * limbs;
+		uint64_t carry = half;
+		for (long k = w; k < limbs && carry; ++k) {
+			x[k] += carry;
+			carry = x[k] < carry;
+		}
+		x[limbs - 1] &= mask;
+	}
+	rightShiftLimbsAndEqual(p, bits, shift, degree);
+}
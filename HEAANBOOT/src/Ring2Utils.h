@@ -4,13 +4,16 @@
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
 
+#include "Key.h"
+#include "RingMultiplier.h"
+#include "ScratchArena.h"
+#include "SparsePoly.h"
+
 using namespace NTL;
 
 class Ring2Utils {
 	public:
 
-		//-----------------------------------------
-
 		static void mod(ZZX& res, ZZX& p, ZZ& mod, const long& degree);
 
 		static void modAndEqual(ZZX& p, ZZ& mod, const long& degree);
@@ -117,8 +120,9 @@ class Ring2Utils {
 		 * @param[in] p2 in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 */
-		static void mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree);
+		static void mult(ZZX& res, ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 
 		/**
 		 * multiplication in ring Z_q[X] / (X^N + 1)
@@ -126,9 +130,10 @@ class Ring2Utils {
 		 * @param[in] p2 in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 * @result p1 * p2 in Z_q[X] / (X^N + 1)
 		 */
-		static ZZX mult(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree);
+		static ZZX mult(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 
 //		static void mult(CZZX& res, CZZX& p1, CZZX& p2, ZZ& mod, const long& degree);
 //		static void mult(CZZX& res, CZZX& p1, ZZX& p2, ZZ& mod, const long& degree);
@@ -139,8 +144,9 @@ class Ring2Utils {
 		 * @param[in] p2 in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 */
-		static void multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree);
+		static void multAndEqual(ZZX& p1, ZZX& p2, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 
 //		static void multAndEqual(CZZX& p1, CZZX& p2, ZZ& mod, const long& degree);
 //		static void multAndEqual(CZZX& p1, ZZX& p2, ZZ& mod, const long& degree);
@@ -153,17 +159,19 @@ class Ring2Utils {
 		 * @param[in] p in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 */
-		static void square(ZZX& res, ZZX& p, ZZ& mod, const long& degree);
+		static void square(ZZX& res, ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 
 		/**
 		 * square in ring Z_q[X] / (X^N + 1)
 		 * @param[in] p in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 * @result p^2 in Z_q[X] / (X^N + 1)
 		 */
-		static ZZX square(ZZX& p, ZZ& mod, const long& degree);
+		static ZZX square(ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 
 //		static void square(CZZX& res, CZZX& p, ZZ& mod, const long& degree);
 
@@ -172,10 +180,35 @@ class Ring2Utils {
 		 * @param[in, out] p -> p^2 in Z_q[X] / (X^N + 1)
 		 * @param[in] mod q
 		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
 		 */
-		static void squareAndEqual(ZZX& p, ZZ& mod, const long& degree);
+		static void squareAndEqual(ZZX& p, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
 //		static void squareAndEqual(CZZX& p, ZZ& mod, const long& degree);
 
+		/**
+		 * multiplication by switching key, uses residues of key in NTT form if they are precomputed
+		 * @param[out] resa p * key.ax in Z_q[X] / (X^N + 1)
+		 * @param[out] resb p * key.bx in Z_q[X] / (X^N + 1)
+		 * @param[in] p in Z_q[X] / (X^N + 1), can be the same as resa or resb
+		 * @param[in] key switching key
+		 * @param[in] mod q
+		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
+		 */
+		static void multByKey(ZZX& resa, ZZX& resb, ZZX& p, Key& key, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
+
+		/**
+		 * multiplication by sparse polynomial, uses residues of s in NTT form if they are precomputed,
+		 * otherwise multiplies directly if s has at most SPARSE_DIRECT_NUM coefficients
+		 * @param[out] res p * s in Z_q[X] / (X^N + 1)
+		 * @param[in] p in Z_q[X] / (X^N + 1), can be the same as res
+		 * @param[in] s sparse polynomial
+		 * @param[in] mod q
+		 * @param[in] degree N
+		 * @param[in] multiplier RNS backend of context, NTL multiplication is used if NULL
+		 */
+		static void multBySparse(ZZX& res, ZZX& p, SparsePoly& s, ZZ& mod, const long& degree, RingMultiplier* multiplier = NULL);
+
 		//-----------------------------------------
 
 		/**
@@ -298,6 +331,31 @@ class Ring2Utils {
 		static void rightShiftAndEqual(ZZX& p, const long& bits, const long& degree);
 //		static void rightShiftAndEqual(CZZX& p, const long& bits, const long& logMod, const long& degree);
 
+		/**
+		 * division by 2^b with rounding to nearest in ring Z_q[X] / (X^N + 1)
+		 * @param[out] round(p / 2^b) in Z_q[X] / (X^N + 1)
+		 * @param[in] p in Z_q[X] / (X^N + 1)
+		 * @param[in] degree b
+		 * @param[in] degree N
+		 */
+		static void rightShiftRound(ZZX& res, ZZX& p, const long& bits, const long& degree);
+
+		/**
+		 * division by 2^b with rounding to nearest in ring Z_q[X] / (X^N + 1)
+		 * @param[in,out] p -> round(p / 2^b) in Z_q[X] / (X^N + 1)
+		 * @param[in] degree b
+		 * @param[in] degree N
+		 */
+		static void rightShiftRoundAndEqual(ZZX& p, const long& bits, const long& degree);
+
+		/**
+		 * division of one coefficient by 2^b with rounding to nearest
+		 * @param[in,out] x -> round(x / 2^b)
+		 * @param[in] half 2^(b-1), zero for b = 0
+		 * @param[in] degree b
+		 */
+		static void rightShiftRound(ZZ& x, const ZZ& half, const long& bits);
+
 		//-----------------------------------------
 
 		/**
@@ -339,6 +397,62 @@ class Ring2Utils {
 		 * @result <pvec1, pvec2>
 		 */
 		static ZZX innerProduct(ZZX*& pvec1, ZZX*& pvec2, const long& size, ZZ& mod, const long& degree);
+
+		//-----------------------------------------
+
+		/**
+		 * writes coefficients of p reduced to [0, 2^bits) as arrays of words
+		 * @param[out] res array of degree * ceil(bits / 64) words
+		 * @param[in] p in Z_(2^bits)[X] / (X^N + 1)
+		 * @param[in] bits log of modulus
+		 * @param[in] degree N
+		 */
+		static void toLimbs(uint64_t* res, ZZX& p, const long& bits, const long& degree);
+
+		/**
+		 * @param[out] res polynomial with coefficients read from words
+		 * @param[in] p array of degree * limbs words
+		 * @param[in] limbs words per coefficient
+		 * @param[in] degree N
+		 */
+		static void fromLimbs(ZZX& res, uint64_t* p, const long& limbs, const long& degree);
+
+		/**
+		 * addition in ring Z_(2^bits)[X] / (X^N + 1) on arrays of words
+		 * @param[in, out] p1 -> p1 + p2
+		 * @param[in] p2
+		 * @param[in] bits log of modulus
+		 * @param[in] degree N
+		 */
+		static void addLimbsAndEqual(uint64_t* p1, uint64_t* p2, const long& bits, const long& degree);
+
+		/**
+		 * subtraction in ring Z_(2^bits)[X] / (X^N + 1) on arrays of words
+		 * @param[in, out] p1 -> p1 - p2
+		 * @param[in] p2
+		 * @param[in] bits log of modulus
+		 * @param[in] degree N
+		 */
+		static void subLimbsAndEqual(uint64_t* p1, uint64_t* p2, const long& bits, const long& degree);
+
+		/**
+		 * division by 2^b on arrays of words, coefficients are repacked in place with less words if possible
+		 * @param[in, out] p in Z_(2^bits)[X] / (X^N + 1) -> p / 2^b in Z_(2^(bits - b))[X] / (X^N + 1)
+		 * @param[in] bits log of modulus of p
+		 * @param[in] shift b
+		 * @param[in] degree N
+		 */
+		static void rightShiftLimbsAndEqual(uint64_t* p, const long& bits, const long& shift, const long& degree);
+
+		/**
+		 * division by 2^b with rounding to nearest on arrays of words
+		 * @param[in, out] p in Z_(2^bits)[X] / (X^N + 1) -> round(p / 2^b) in Z_(2^(bits - b))[X] / (X^N + 1)
+		 * @param[in] bits log of modulus of p
+		 * @param[in] shift b
+		 * @param[in] degree N
+		 */
+		static void rightShiftRoundLimbsAndEqual(uint64_t* p, const long& bits, const long& shift, const long& degree);
+
 		//-----------------------------------------
 
 };
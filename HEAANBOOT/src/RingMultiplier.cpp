@@ -0,0 +1,532 @@
+#include "RingMultiplier.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+
+__attribute__((target("avx2")))
+static inline __m256i mulLo64AVX2(__m256i a, __m256i b) {
+	__m256i ahi = _mm256_srli_epi64(a, 32);
+	__m256i bhi = _mm256_srli_epi64(b, 32);
+	__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(a, bhi), _mm256_mul_epu32(ahi, b));
+	return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i mulHi64AVX2(__m256i a, __m256i b) {
+	__m256i mask = _mm256_set1_epi64x(0xffffffff);
+	__m256i ahi = _mm256_srli_epi64(a, 32);
+	__m256i bhi = _mm256_srli_epi64(b, 32);
+	__m256i lolo = _mm256_mul_epu32(a, b);
+	__m256i lohi = _mm256_mul_epu32(a, bhi);
+	__m256i hilo = _mm256_mul_epu32(ahi, b);
+	__m256i hihi = _mm256_mul_epu32(ahi, bhi);
+	__m256i mid = _mm256_add_epi64(_mm256_srli_epi64(lolo, 32), _mm256_add_epi64(_mm256_and_si256(lohi, mask), _mm256_and_si256(hilo, mask)));
+	__m256i hi = _mm256_add_epi64(hihi, _mm256_add_epi64(_mm256_srli_epi64(lohi, 32), _mm256_srli_epi64(hilo, 32)));
+	return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+}
+
+/**
+ * x -= bnd if x >= bnd, all values are below 2^63 so signed comparison is enough
+ */
+__attribute__((target("avx2")))
+static inline __m256i reduceAVX2(__m256i x, __m256i bnd) {
+	__m256i mask = _mm256_cmpgt_epi64(bnd, x);
+	return _mm256_sub_epi64(x, _mm256_andnot_si256(mask, bnd));
+}
+
+__attribute__((target("avx2")))
+static void butterflyCTAVX2(uint64_t* x, uint64_t* y, long t, uint64_t w, uint64_t wprecon, uint64_t p) {
+	__m256i vp = _mm256_set1_epi64x(p);
+	__m256i vp2 = _mm256_set1_epi64x(2 * p);
+	__m256i vw = _mm256_set1_epi64x(w);
+	__m256i vwprecon = _mm256_set1_epi64x(wprecon);
+	for (long j = 0; j < t; j += 4) {
+		__m256i vx = _mm256_loadu_si256((__m256i*) (x + j));
+		__m256i vy = _mm256_loadu_si256((__m256i*) (y + j));
+		vx = reduceAVX2(vx, vp2);
+		__m256i vq = mulHi64AVX2(vy, vwprecon);
+		__m256i vt = _mm256_sub_epi64(mulLo64AVX2(vy, vw), mulLo64AVX2(vq, vp));
+		_mm256_storeu_si256((__m256i*) (x + j), _mm256_add_epi64(vx, vt));
+		_mm256_storeu_si256((__m256i*) (y + j), _mm256_add_epi64(_mm256_sub_epi64(vx, vt), vp2));
+	}
+}
+
+__attribute__((target("avx2")))
+static void butterflyGSAVX2(uint64_t* x, uint64_t* y, long t, uint64_t w, uint64_t wprecon, uint64_t p) {
+	__m256i vp = _mm256_set1_epi64x(p);
+	__m256i vp2 = _mm256_set1_epi64x(2 * p);
+	__m256i vw = _mm256_set1_epi64x(w);
+	__m256i vwprecon = _mm256_set1_epi64x(wprecon);
+	for (long j = 0; j < t; j += 4) {
+		__m256i vx = _mm256_loadu_si256((__m256i*) (x + j));
+		__m256i vy = _mm256_loadu_si256((__m256i*) (y + j));
+		__m256i vt = _mm256_add_epi64(_mm256_sub_epi64(vx, vy), vp2);
+		_mm256_storeu_si256((__m256i*) (x + j), reduceAVX2(_mm256_add_epi64(vx, vy), vp2));
+		__m256i vq = mulHi64AVX2(vt, vwprecon);
+		_mm256_storeu_si256((__m256i*) (y + j), _mm256_sub_epi64(mulLo64AVX2(vt, vw), mulLo64AVX2(vq, vp)));
+	}
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static inline __m512i mulHi64AVX512(__m512i a, __m512i b) {
+	__m512i mask = _mm512_set1_epi64(0xffffffff);
+	__m512i ahi = _mm512_srli_epi64(a, 32);
+	__m512i bhi = _mm512_srli_epi64(b, 32);
+	__m512i lolo = _mm512_mul_epu32(a, b);
+	__m512i lohi = _mm512_mul_epu32(a, bhi);
+	__m512i hilo = _mm512_mul_epu32(ahi, b);
+	__m512i hihi = _mm512_mul_epu32(ahi, bhi);
+	__m512i mid = _mm512_add_epi64(_mm512_srli_epi64(lolo, 32), _mm512_add_epi64(_mm512_and_si512(lohi, mask), _mm512_and_si512(hilo, mask)));
+	__m512i hi = _mm512_add_epi64(hihi, _mm512_add_epi64(_mm512_srli_epi64(lohi, 32), _mm512_srli_epi64(hilo, 32)));
+	return _mm512_add_epi64(hi, _mm512_srli_epi64(mid, 32));
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void butterflyCTAVX512(uint64_t* x, uint64_t* y, long t, uint64_t w, uint64_t wprecon, uint64_t p) {
+	__m512i vp = _mm512_set1_epi64(p);
+	__m512i vp2 = _mm512_set1_epi64(2 * p);
+	__m512i vw = _mm512_set1_epi64(w);
+	__m512i vwprecon = _mm512_set1_epi64(wprecon);
+	for (long j = 0; j < t; j += 8) {
+		__m512i vx = _mm512_loadu_si512((void*) (x + j));
+		__m512i vy = _mm512_loadu_si512((void*) (y + j));
+		vx = _mm512_min_epu64(vx, _mm512_sub_epi64(vx, vp2));
+		__m512i vq = mulHi64AVX512(vy, vwprecon);
+		__m512i vt = _mm512_sub_epi64(_mm512_mullo_epi64(vy, vw), _mm512_mullo_epi64(vq, vp));
+		_mm512_storeu_si512((void*) (x + j), _mm512_add_epi64(vx, vt));
+		_mm512_storeu_si512((void*) (y + j), _mm512_add_epi64(_mm512_sub_epi64(vx, vt), vp2));
+	}
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static void butterflyGSAVX512(uint64_t* x, uint64_t* y, long t, uint64_t w, uint64_t wprecon, uint64_t p) {
+	__m512i vp = _mm512_set1_epi64(p);
+	__m512i vp2 = _mm512_set1_epi64(2 * p);
+	__m512i vw = _mm512_set1_epi64(w);
+	__m512i vwprecon = _mm512_set1_epi64(wprecon);
+	for (long j = 0; j < t; j += 8) {
+		__m512i vx = _mm512_loadu_si512((void*) (x + j));
+		__m512i vy = _mm512_loadu_si512((void*) (y + j));
+		__m512i vt = _mm512_add_epi64(_mm512_sub_epi64(vx, vy), vp2);
+		__m512i vs = _mm512_add_epi64(vx, vy);
+		_mm512_storeu_si512((void*) (x + j), _mm512_min_epu64(vs, _mm512_sub_epi64(vs, vp2)));
+		__m512i vq = mulHi64AVX512(vt, vwprecon);
+		_mm512_storeu_si512((void*) (y + j), _mm512_sub_epi64(_mm512_mullo_epi64(vt, vw), _mm512_mullo_epi64(vq, vp)));
+	}
+}
+#endif
+
+
+RingMultiplier::RingMultiplier(long logN, long logQ) : logN(logN) {
+	N = 1 << logN;
+	simd = detectSimd();
+	long M = N << 1;
+	maxnp = (4 * logQ + logN + 2) / (pbnd - 1) + 1;
+
+	pVec = new uint64_t[maxnp];
+	scaledRootPows = new uint64_t*[maxnp];
+	scaledRootPowsPrecon = new uint64_t*[maxnp];
+	scaledRootInvPows = new uint64_t*[maxnp];
+	scaledRootInvPowsPrecon = new uint64_t*[maxnp];
+	NInvVec = new uint64_t[maxnp];
+	NInvPreconVec = new uint64_t[maxnp];
+	barrettVec = new uint64_t[maxnp];
+
+	uint64_t primetest = ((1ULL << pbnd) - 1) / M * M + 1;
+	for (long i = 0; i < maxnp; ++i) {
+		while(true) {
+			primetest -= M;
+			if(ProbPrime((long)primetest)) {
+				pVec[i] = primetest;
+				break;
+			}
+		}
+	}
+
+	for (long i = 0; i < maxnp; ++i) {
+		uint64_t p = pVec[i];
+		uint64_t root = findPrimitive2NthRoot(p, N);
+		uint64_t rootinv = invMod(root, p);
+
+		scaledRootPows[i] = new uint64_t[N];
+		scaledRootPowsPrecon[i] = new uint64_t[N];
+		scaledRootInvPows[i] = new uint64_t[N];
+		scaledRootInvPowsPrecon[i] = new uint64_t[N];
+
+		uint64_t power = 1;
+		uint64_t powerInv = 1;
+		for (long j = 0; j < N; ++j) {
+			uint32_t jrev = bitReverse(j, logN);
+			scaledRootPows[i][jrev] = power;
+			scaledRootPowsPrecon[i][jrev] = precon(power, p);
+			scaledRootInvPows[i][jrev] = powerInv;
+			scaledRootInvPowsPrecon[i][jrev] = precon(powerInv, p);
+			power = mulMod(power, root, p);
+			powerInv = mulMod(powerInv, rootinv, p);
+		}
+		NInvVec[i] = invMod(N, p);
+		NInvPreconVec[i] = precon(NInvVec[i], p);
+		barrettVec[i] = (uint64_t) (((unsigned __int128) 1 << (2 * pbnd)) / p);
+	}
+
+	pProd = new ZZ[maxnp];
+	pProdh = new ZZ[maxnp];
+	pHat = new ZZ*[maxnp];
+	pHatInvModp = new uint64_t*[maxnp];
+
+	pProd[0] = to_ZZ((long)pVec[0]);
+	for (long np = 1; np < maxnp; ++np) {
+		pProd[np] = pProd[np - 1] * (long)pVec[np];
+	}
+	for (long np = 0; np < maxnp; ++np) {
+		pProdh[np] = pProd[np] / 2;
+		pHat[np] = new ZZ[np + 1];
+		pHatInvModp[np] = new uint64_t[np + 1];
+		for (long i = 0; i < np + 1; ++i) {
+			pHat[np][i] = pProd[np] / (long)pVec[i];
+			uint64_t pHatModp = rem(pHat[np][i], (long)pVec[i]);
+			pHatInvModp[np][i] = invMod(pHatModp, pVec[i]);
+		}
+	}
+}
+
+//-----------------------------------------
+
+long RingMultiplier::numPrimes(const long& bits) {
+	long np = (bits + 1) / (pbnd - 1) + 1;
+	return np <= maxnp ? np : -1;
+}
+
+long RingMultiplier::maxBits(ZZX& p, const long& degree) {
+	long res = 0;
+	long len = min(degree, p.rep.length());
+	for (long i = 0; i < len; ++i) {
+		long bits = NumBits(p.rep[i]);
+		if(bits > res) res = bits;
+	}
+	return res;
+}
+
+//-----------------------------------------
+
+long RingMultiplier::detectSimd() {
+#if defined(__x86_64__) && defined(__GNUC__)
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return SIMD_AVX512;
+	if(__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#endif
+	return SIMD_SCALAR;
+}
+
+void RingMultiplier::NTT(uint64_t* a, long index) {
+	uint64_t p = pVec[index];
+	uint64_t p2 = p << 1;
+	uint64_t* W = scaledRootPows[index];
+	uint64_t* Wprecon = scaledRootPowsPrecon[index];
+	long t = N;
+	for (long m = 1; m < N; m <<= 1) {
+		t >>= 1;
+		for (long i = 0; i < m; ++i) {
+			uint64_t* x = a + 2 * i * t;
+			uint64_t* y = x + t;
+			uint64_t w = W[m + i];
+			uint64_t wprecon = Wprecon[m + i];
+#if defined(__x86_64__) && defined(__GNUC__)
+			if(simd == SIMD_AVX512 && t >= 8) {
+				butterflyCTAVX512(x, y, t, w, wprecon, p);
+				continue;
+			}
+			if(simd != SIMD_SCALAR && t >= 4) {
+				butterflyCTAVX2(x, y, t, w, wprecon, p);
+				continue;
+			}
+#endif
+			for (long j = 0; j < t; ++j) {
+				uint64_t u = x[j] >= p2 ? x[j] - p2 : x[j];
+				uint64_t v = mulModPreconLazy(y[j], w, wprecon, p);
+				x[j] = u + v;
+				y[j] = u - v + p2;
+			}
+		}
+	}
+	for (long j = 0; j < N; ++j) {
+		if(a[j] >= p2) a[j] -= p2;
+		if(a[j] >= p) a[j] -= p;
+	}
+}
+
+void RingMultiplier::INTT(uint64_t* a, long index) {
+	uint64_t p = pVec[index];
+	uint64_t p2 = p << 1;
+	uint64_t* W = scaledRootInvPows[index];
+	uint64_t* Wprecon = scaledRootInvPowsPrecon[index];
+	long t = 1;
+	for (long m = N; m > 1; m >>= 1) {
+		long h = m >> 1;
+		for (long i = 0; i < h; ++i) {
+			uint64_t* x = a + 2 * i * t;
+			uint64_t* y = x + t;
+			uint64_t w = W[h + i];
+			uint64_t wprecon = Wprecon[h + i];
+#if defined(__x86_64__) && defined(__GNUC__)
+			if(simd == SIMD_AVX512 && t >= 8) {
+				butterflyGSAVX512(x, y, t, w, wprecon, p);
+				continue;
+			}
+			if(simd != SIMD_SCALAR && t >= 4) {
+				butterflyGSAVX2(x, y, t, w, wprecon, p);
+				continue;
+			}
+#endif
+			for (long j = 0; j < t; ++j) {
+				uint64_t u = x[j] + y[j];
+				uint64_t v = x[j] - y[j] + p2;
+				x[j] = u >= p2 ? u - p2 : u;
+				y[j] = mulModPreconLazy(v, w, wprecon, p);
+			}
+		}
+		t <<= 1;
+	}
+	for (long j = 0; j < N; ++j) {
+		a[j] = mulModPrecon(a[j], NInvVec[index], NInvPreconVec[index], p);
+	}
+}
+
+void RingMultiplier::toNTT(uint64_t* rx, ZZX& x, long np) {
+	long len = min(N, x.rep.length());
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		long p = pVec[i];
+		for (long j = 0; j < len; ++j) {
+			rxi[j] = rem(x.rep[j], p);
+		}
+		for (long j = len; j < N; ++j) {
+			rxi[j] = 0;
+		}
+		NTT(rxi, i);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::reconstruct(ZZX& x, uint64_t* rx, long np, ZZ& mod) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		INTT(rx + (i << logN), i);
+	}
+	NTL_EXEC_RANGE_END;
+	ZZ* pHatnp = pHat[np - 1];
+	uint64_t* pHatInvModpnp = pHatInvModp[np - 1];
+
+	x.SetLength(N);
+	NTL_EXEC_RANGE(N, first, last);
+	ScratchArena::Frame frame;
+	ZZ& acc = frame.number();
+	ZZ& tmp = frame.number();
+	for (long j = first; j < last; ++j) {
+		clear(acc);
+		for (long i = 0; i < np; ++i) {
+			uint64_t s = mulMod(rx[j + (i << logN)], pHatInvModpnp[i], pVec[i]);
+			mul(tmp, pHatnp[i], (long)s);
+			acc += tmp;
+		}
+		rem(acc, acc, pProd[np - 1]);
+		if(acc > pProdh[np - 1]) {
+			acc -= pProd[np - 1];
+		}
+		rem(x.rep[j], acc, mod);
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+//-----------------------------------------
+
+bool RingMultiplier::mult(ZZX& x, ZZX& a, ZZX& b, ZZ& mod) {
+	if(a.rep.length() > N || b.rep.length() > N) return false;
+	long np = numPrimes(maxBits(a, N) + maxBits(b, N) + logN);
+	if(np < 0) return false;
+
+	ScratchArena::Frame frame;
+	uint64_t* ra = frame.words(np << logN);
+	uint64_t* rb = frame.words(np << logN);
+	toNTT(ra, a, np);
+	toNTT(rb, b, np);
+	multResidues(ra, ra, rb, np);
+	reconstruct(x, ra, np, mod);
+	return true;
+}
+
+bool RingMultiplier::square(ZZX& x, ZZX& a, ZZ& mod) {
+	if(a.rep.length() > N) return false;
+	long np = numPrimes(2 * maxBits(a, N) + logN);
+	if(np < 0) return false;
+
+	ScratchArena::Frame frame;
+	uint64_t* ra = frame.words(np << logN);
+	toNTT(ra, a, np);
+	multResidues(ra, ra, ra, np);
+	reconstruct(x, ra, np, mod);
+	return true;
+}
+
+bool RingMultiplier::multNTT(ZZX& x1, ZZX& x2, ZZX& a, uint64_t* rb1, uint64_t* rb2, long bbits, long nbp, ZZ& mod) {
+	if(a.rep.length() > N) return false;
+	long np = numPrimes(maxBits(a, N) + bbits + logN);
+	if(np < 0 || np > nbp) return false;
+
+	ScratchArena::Frame frame;
+	uint64_t* ra1 = frame.words(np << logN);
+	uint64_t* ra2 = frame.words(np << logN);
+	toNTT(ra1, a, np);
+	multResidues(ra2, ra1, rb2, np);
+	multResidues(ra1, ra1, rb1, np);
+	reconstruct(x1, ra1, np, mod);
+	reconstruct(x2, ra2, np, mod);
+	return true;
+}
+
+bool RingMultiplier::multNTT(ZZX& x, ZZX& a, uint64_t* rb, long bbits, long nbp, ZZ& mod) {
+	if(a.rep.length() > N) return false;
+	long np = numPrimes(maxBits(a, N) + bbits + logN);
+	if(np < 0 || np > nbp) return false;
+
+	ScratchArena::Frame frame;
+	uint64_t* ra = frame.words(np << logN);
+	toNTT(ra, a, np);
+	multResidues(ra, ra, rb, np);
+	reconstruct(x, ra, np, mod);
+	return true;
+}
+
+void RingMultiplier::multResidues(uint64_t* rx, uint64_t* ra, uint64_t* rb, long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		uint64_t* rbi = rb + (i << logN);
+		uint64_t p = pVec[i];
+		uint64_t barrett = barrettVec[i];
+		for (long j = 0; j < N; ++j) {
+			rxi[j] = mulModBarrett(rai[j], rbi[j], barrett, p);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::multAddResidues(uint64_t* rx, uint64_t* ra, uint64_t* rb, long np) {
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		uint64_t* rbi = rb + (i << logN);
+		uint64_t p = pVec[i];
+		uint64_t barrett = barrettVec[i];
+		for (long j = 0; j < N; ++j) {
+			uint64_t t = rxi[j] + mulModBarrett(rai[j], rbi[j], barrett, p);
+			rxi[j] = t >= p ? t - p : t;
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void RingMultiplier::automorphism(uint64_t* rx, uint64_t* ra, Automorphism& automorphism, long np) {
+	long* index = automorphism.nttIndex;
+	NTL_EXEC_RANGE(np, first, last);
+	for (long i = first; i < last; ++i) {
+		uint64_t* rxi = rx + (i << logN);
+		uint64_t* rai = ra + (i << logN);
+		for (long j = 0; j < N; ++j) {
+			rxi[j] = rai[index[j]];
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+//-----------------------------------------
+
+uint64_t RingMultiplier::mulMod(uint64_t a, uint64_t b, uint64_t p) {
+	unsigned __int128 mul = (unsigned __int128) a * b;
+	return (uint64_t) (mul % p);
+}
+
+uint64_t RingMultiplier::powMod(uint64_t x, uint64_t y, uint64_t p) {
+	uint64_t res = 1;
+	while(y > 0) {
+		if(y & 1) {
+			res = mulMod(res, x, p);
+		}
+		y >>= 1;
+		x = mulMod(x, x, p);
+	}
+	return res;
+}
+
+uint64_t RingMultiplier::invMod(uint64_t x, uint64_t p) {
+	return powMod(x, p - 2, p);
+}
+
+uint64_t RingMultiplier::precon(uint64_t W, uint64_t p) {
+	unsigned __int128 Wshift = (unsigned __int128) W << 64;
+	return (uint64_t) (Wshift / p);
+}
+
+uint64_t RingMultiplier::mulModPrecon(uint64_t x, uint64_t W, uint64_t Wprecon, uint64_t p) {
+	uint64_t q = (uint64_t) (((unsigned __int128) x * Wprecon) >> 64);
+	uint64_t res = x * W - q * p;
+	return res >= p ? res - p : res;
+}
+
+uint64_t RingMultiplier::mulModPreconLazy(uint64_t x, uint64_t W, uint64_t Wprecon, uint64_t p) {
+	uint64_t q = (uint64_t) (((unsigned __int128) x * Wprecon) >> 64);
+	return x * W - q * p;
+}
+
+uint64_t RingMultiplier::mulModBarrett(uint64_t a, uint64_t b, uint64_t barrett, uint64_t p) {
+	unsigned __int128 mul = (unsigned __int128) a * b;
+	uint64_t q = (uint64_t) ((((unsigned __int128) (uint64_t) (mul >> (pbnd - 1))) * barrett) >> (pbnd + 1));
+	uint64_t res = (uint64_t) mul - q * p;
+	res = res >= p ? res - p : res;
+	return res >= p ? res - p : res;
+}
+
+uint32_t RingMultiplier::bitReverse(uint32_t x, long logN) {
+	uint32_t res = 0;
+	for (long i = 0; i < logN; ++i) {
+		res = (res << 1) | (x & 1);
+		x >>= 1;
+	}
+	return res;
+}
+
+uint64_t RingMultiplier::findPrimitive2NthRoot(uint64_t p, long N) {
+	uint64_t M = N << 1;
+	for (uint64_t g = 2; ; ++g) {
+		uint64_t root = powMod(g, (p - 1) / M, p);
+		if(powMod(root, N, p) == p - 1) {
+			return root;
+		}
+	}
+}
+
+RingMultiplier::~RingMultiplier() {
+	for (long i = 0; i < maxnp; ++i) {
+		delete[] scaledRootPows[i];
+		delete[] scaledRootPowsPrecon[i];
+		delete[] scaledRootInvPows[i];
+		delete[] scaledRootInvPowsPrecon[i];
+		delete[] pHat[i];
+		delete[] pHatInvModp[i];
+	}
+	delete[] scaledRootPows;
+	delete[] scaledRootPowsPrecon;
+	delete[] scaledRootInvPows;
+	delete[] scaledRootInvPowsPrecon;
+	delete[] pHat;
+	delete[] pHatInvModp;
+	delete[] pVec;
+	delete[] NInvVec;
+	delete[] NInvPreconVec;
+	delete[] barrettVec;
+	delete[] pProd;
+	delete[] pProdh;
+}
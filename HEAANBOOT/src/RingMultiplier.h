@@ -0,0 +1,228 @@
+#ifndef HEAAN_RINGMULTIPLIER_H_
+#define HEAAN_RINGMULTIPLIER_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+#include <NTL/BasicThreadPool.h>
+#include <stdint.h>
+
+#include "Automorphism.h"
+#include "Common.h"
+#include "ScratchArena.h"
+
+using namespace std;
+using namespace NTL;
+
+static const long pbnd = 59; ///< bit size of word-sized NTT primes, 4p < 2^64 is needed for lazy reduction
+
+static const long SIMD_SCALAR = 0; ///< portable NTT butterflies
+static const long SIMD_AVX2 = 1; ///< NTT butterflies on 4 lanes of 64 bits
+static const long SIMD_AVX512 = 2; ///< NTT butterflies on 8 lanes of 64 bits
+
+/**
+ * Multiplication in Z_q[X] / (X^N + 1) through the residue number system:
+ * coefficients are reduced modulo word-sized primes p = 1 mod 2N,
+ * multiplied with negacyclic NTT and lifted back with CRT.
+ * Residues of a polynomial are stored prime by prime: rx[i * N + j] = x_j mod p_i.
+ * Loops over primes and CRT over coefficients run on the NTL thread pool
+ */
+class RingMultiplier {
+public:
+
+	long logN;
+	long N;
+	long maxnp; ///< number of generated primes
+	long simd; ///< NTT kernels chosen at runtime: SIMD_SCALAR, SIMD_AVX2 or SIMD_AVX512
+
+	uint64_t* pVec; ///< NTT primes
+	uint64_t** scaledRootPows; ///< powers of 2N-th root of unity in bit-reversed order
+	uint64_t** scaledRootPowsPrecon; ///< Shoup precomputation for scaledRootPows
+	uint64_t** scaledRootInvPows; ///< powers of inverse 2N-th root of unity in bit-reversed order
+	uint64_t** scaledRootInvPowsPrecon; ///< Shoup precomputation for scaledRootInvPows
+	uint64_t* NInvVec; ///< N^(-1) mod p
+	uint64_t* NInvPreconVec; ///< Shoup precomputation for NInvVec
+	uint64_t* barrettVec; ///< floor(2^(2 * pbnd) / p), Barrett precomputation for pVec
+
+	ZZ* pProd; ///< pProd[np - 1] = p_0 * ... * p_(np-1)
+	ZZ* pProdh; ///< pProdh[np - 1] = pProd[np - 1] / 2
+	ZZ** pHat; ///< pHat[np - 1][i] = pProd[np - 1] / p_i
+	uint64_t** pHatInvModp; ///< pHatInvModp[np - 1][i] = pHat[np - 1][i]^(-1) mod p_i
+
+	/**
+	 * generates enough primes to multiply polynomials with coefficients up to 2^(2 * logQ)
+	 * @param[in] logN degree of the ring
+	 * @param[in] logQ log of the largest modulus used in key switching
+	 */
+	RingMultiplier(long logN, long logQ);
+
+	//-----------------------------------------
+
+	/**
+	 * @param[in] bits bound on log of absolute values of product coefficients
+	 * @return number of primes needed for exact CRT reconstruction or -1 if not enough primes
+	 */
+	long numPrimes(const long& bits);
+
+	/**
+	 * @param[in] p polynomial
+	 * @return maximal number of bits in coefficients of p
+	 */
+	static long maxBits(ZZX& p, const long& degree);
+
+	//-----------------------------------------
+
+	/**
+	 * @return best NTT kernels supported by the running CPU
+	 */
+	static long detectSimd();
+
+	/**
+	 * forward negacyclic NTT modulo p_index, natural order in, bit-reversed order out,
+	 * butterflies keep values in [0, 4p) as in Harvey NTT and the output is reduced to [0, p)
+	 * @param[in, out] a array of N residues
+	 * @param[in] index of prime
+	 */
+	void NTT(uint64_t* a, long index);
+
+	/**
+	 * inverse negacyclic NTT modulo p_index, bit-reversed order in, natural order out,
+	 * input is in [0, 2p), butterflies keep values in [0, 2p) and the output is reduced to [0, p)
+	 * @param[in, out] a array of N residues
+	 * @param[in] index of prime
+	 */
+	void INTT(uint64_t* a, long index);
+
+	/**
+	 * reduces p modulo first np primes and transforms the residues
+	 * @param[out] rx array of np * N residues in NTT form
+	 * @param[in] x polynomial
+	 * @param[in] np number of primes
+	 */
+	void toNTT(uint64_t* rx, ZZX& x, long np);
+
+	/**
+	 * inverse transform of residues and CRT lift to (-pProd/2, pProd/2] reduced modulo mod
+	 * @param[out] x polynomial
+	 * @param[in, out] rx array of np * N residues in NTT form, destroyed
+	 * @param[in] np number of primes
+	 * @param[in] mod modulus
+	 */
+	void reconstruct(ZZX& x, uint64_t* rx, long np, ZZ& mod);
+
+	//-----------------------------------------
+
+	/**
+	 * multiplication in ring Z_q[X] / (X^N + 1)
+	 * @param[out] x = a * b in Z_q[X] / (X^N + 1)
+	 * @param[in] a in Z_q[X] / (X^N + 1)
+	 * @param[in] b in Z_q[X] / (X^N + 1)
+	 * @param[in] mod q
+	 * @return false if a and b are too large for generated primes, x is not changed then
+	 */
+	bool mult(ZZX& x, ZZX& a, ZZX& b, ZZ& mod);
+
+	/**
+	 * square in ring Z_q[X] / (X^N + 1)
+	 * @param[out] x = a^2 in Z_q[X] / (X^N + 1)
+	 * @param[in] a in Z_q[X] / (X^N + 1)
+	 * @param[in] mod q
+	 * @return false if a is too large for generated primes, x is not changed then
+	 */
+	bool square(ZZX& x, ZZX& a, ZZ& mod);
+
+	/**
+	 * multiplication of a by two polynomials given in NTT form, a is transformed only once
+	 * @param[out] x1 = a * b1 in Z_q[X] / (X^N + 1)
+	 * @param[out] x2 = a * b2 in Z_q[X] / (X^N + 1)
+	 * @param[in] a in Z_q[X] / (X^N + 1)
+	 * @param[in] rb1 residues of b1 in NTT form
+	 * @param[in] rb2 residues of b2 in NTT form
+	 * @param[in] bbits bound on number of bits in coefficients of b1 and b2
+	 * @param[in] nbp number of primes in rb1 and rb2
+	 * @param[in] mod q
+	 * @return false if nbp primes are not enough for the product, x1 and x2 are not changed then
+	 */
+	bool multNTT(ZZX& x1, ZZX& x2, ZZX& a, uint64_t* rb1, uint64_t* rb2, long bbits, long nbp, ZZ& mod);
+
+	/**
+	 * multiplication of a by polynomial given in NTT form
+	 * @param[out] x = a * b in Z_q[X] / (X^N + 1)
+	 * @param[in] a in Z_q[X] / (X^N + 1)
+	 * @param[in] rb residues of b in NTT form
+	 * @param[in] bbits bound on number of bits in coefficients of b
+	 * @param[in] nbp number of primes in rb
+	 * @param[in] mod q
+	 * @return false if nbp primes are not enough for the product, x is not changed then
+	 */
+	bool multNTT(ZZX& x, ZZX& a, uint64_t* rb, long bbits, long nbp, ZZ& mod);
+
+	/**
+	 * pointwise multiplication of residues in NTT form
+	 * @param[out] rx residues of a * b
+	 * @param[in] ra residues of a
+	 * @param[in] rb residues of b
+	 * @param[in] np number of primes
+	 */
+	void multResidues(uint64_t* rx, uint64_t* ra, uint64_t* rb, long np);
+
+	/**
+	 * pointwise multiply-accumulate of residues in NTT form
+	 * @param[in, out] rx residues of x, replaced by residues of x + a * b
+	 * @param[in] ra residues of a
+	 * @param[in] rb residues of b
+	 * @param[in] np number of primes
+	 */
+	void multAddResidues(uint64_t* rx, uint64_t* ra, uint64_t* rb, long np);
+
+	/**
+	 * automorphism X -> X^pow applied to residues in NTT form, which is a permutation of evaluation points
+	 * @param[out] rx residues of a(X^pow), different from ra
+	 * @param[in] ra residues of a
+	 * @param[in] automorphism table of X -> X^pow, see Context::automorphism
+	 * @param[in] np number of primes
+	 */
+	void automorphism(uint64_t* rx, uint64_t* ra, Automorphism& automorphism, long np);
+
+	//-----------------------------------------
+
+	static uint64_t mulMod(uint64_t a, uint64_t b, uint64_t p);
+
+	static uint64_t powMod(uint64_t x, uint64_t y, uint64_t p);
+
+	static uint64_t invMod(uint64_t x, uint64_t p);
+
+	/**
+	 * @return floor(W * 2^64 / p)
+	 */
+	static uint64_t precon(uint64_t W, uint64_t p);
+
+	/**
+	 * Shoup multiplication
+	 * @return x * W mod p for x < 2^64
+	 */
+	static uint64_t mulModPrecon(uint64_t x, uint64_t W, uint64_t Wprecon, uint64_t p);
+
+	/**
+	 * Shoup multiplication without final correction
+	 * @return value in [0, 2p) equal to x * W mod p for x < 2^64
+	 */
+	static uint64_t mulModPreconLazy(uint64_t x, uint64_t W, uint64_t Wprecon, uint64_t p);
+
+	/**
+	 * Barrett multiplication
+	 * @param[in] barrett floor(2^(2 * pbnd) / p) for 2^(pbnd - 1) < p < 2^pbnd
+	 * @return a * b mod p for a, b < 2^pbnd
+	 */
+	static uint64_t mulModBarrett(uint64_t a, uint64_t b, uint64_t barrett, uint64_t p);
+
+	static uint32_t bitReverse(uint32_t x, long logN);
+
+	/**
+	 * finds primitive 2N-th root of unity modulo p
+	 */
+	static uint64_t findPrimitive2NthRoot(uint64_t p, long N);
+
+	virtual ~RingMultiplier();
+};
+
+#endif
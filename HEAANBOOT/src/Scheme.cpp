@@ -2,59 +2,70 @@
 
 //-----------------------------------------
 
-Scheme::Scheme(SecretKey& secretKey, Context& context) : context(context) {
+Scheme::Scheme(SecretKey& secretKey, Context& context, long dnum) : context(context), rescaleMode(RESCALE_TRUNCATE), dnum(dnum), useLevelKeys(false) {
 	addEncKey(secretKey);
 	addMultKey(secretKey);
 };
 
+Key Scheme::generateSwitchKey(ZZX& sxFrom, ZZX& sxTo) {
+	ZZX ex, ax, bx, sxshift;
+	unsigned char seed[SEED_BYTES];
+	if(dnum <= 0) {
+		Ring2Utils::leftShift(sxshift, sxFrom, context.logq, context.qq, context.N);
+		NumUtils::sampleSeed(seed);
+		NumUtils::sampleUniform2Seeded(ax, context.N, context.logqq, seed);
+		NumUtils::sampleGauss(ex, context.N, context.sigma);
+		Ring2Utils::addAndEqual(ex, sxshift, context.qq, context.N);
+		Ring2Utils::mult(bx, sxTo, ax, context.qq, context.N, context.multiplier);
+		Ring2Utils::sub(bx, ex, bx, context.qq, context.N);
+		return Key(ax, bx, context, seed);
+	}
+	long logP = (context.logq + dnum - 1) / dnum;
+	long logMod = context.logq + logP;
+	ZZ mod = power2_ZZ(logMod);
+	Key key(dnum, logP);
+	for (long i = 0; i < dnum; ++i) {
+		Ring2Utils::leftShift(sxshift, sxFrom, logP * (i + 1), mod, context.N);
+		NumUtils::sampleSeed(seed);
+		NumUtils::sampleUniform2Seeded(ax, context.N, logMod, seed);
+		NumUtils::sampleGauss(ex, context.N, context.sigma);
+		Ring2Utils::addAndEqual(ex, sxshift, mod, context.N);
+		Ring2Utils::mult(bx, sxTo, ax, mod, context.N, context.multiplier);
+		Ring2Utils::sub(bx, ex, bx, mod, context.N);
+		key.digits[i] = Key(ax, bx, context, seed, logP + NumBits(dnum));
+	}
+	return key;
+}
+
 void Scheme::addEncKey(SecretKey& secretKey) {
 	ZZX ex, ax, bx;
+	unsigned char seed[SEED_BYTES];
 
-	NumUtils::sampleUniform2(ax, context.N, context.logqq);
+	NumUtils::sampleSeed(seed);
+	NumUtils::sampleUniform2Seeded(ax, context.N, context.logqq, seed);
 	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.qq, context.N);
+	Ring2Utils::mult(bx, secretKey.sx, ax, context.qq, context.N, context.multiplier);
 	Ring2Utils::sub(bx, ex, bx, context.qq, context.N);
 
-	keyMap.insert(pair<long, Key>(ENCRYPTION, Key(ax, bx)));
+	keyMap.insert(pair<long, Key>(ENCRYPTION, Key(ax, bx, seed)));
 }
 
 void Scheme::addMultKey(SecretKey& secretKey) {
-	ZZX ex, ax, bx, sxsx;
-
-	Ring2Utils::mult(sxsx, secretKey.sx, secretKey.sx, context.q, context.N);
-	Ring2Utils::leftShiftAndEqual(sxsx, context.logq, context.qq, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logqq);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, sxsx, context.qq, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.qq, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.qq, context.N);
-
-	keyMap.insert(pair<long, Key>(MULTIPLICATION, Key(ax, bx)));
+	ZZX sxsx;
+	Ring2Utils::mult(sxsx, secretKey.sx, secretKey.sx, context.q, context.N, context.multiplier);
+	keyMap.insert(pair<long, Key>(MULTIPLICATION, generateSwitchKey(sxsx, secretKey.sx)));
 }
 
 void Scheme::addConjKey(SecretKey& secretKey) {
-	ZZX ex, ax, bx, sxconj;
+	ZZX sxconj;
 	Ring2Utils::conjugate(sxconj, secretKey.sx, context.N);
-	Ring2Utils::leftShiftAndEqual(sxconj, context.logq, context.qq, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logqq);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, sxconj, context.qq, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.qq, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.qq, context.N);
-
-	keyMap.insert(pair<long, Key>(CONJUGATION, Key(ax, bx)));
+	keyMap.insert(pair<long, Key>(CONJUGATION, generateSwitchKey(sxconj, secretKey.sx)));
 }
 
 void Scheme::addLeftRotKey(SecretKey& secretKey, long rot) {
-	ZZX ex, sxsx, ax, bx, spow;
+	ZZX spow;
 	Ring2Utils::inpower(spow, secretKey.sx, context.rotGroup[rot], context.q, context.N);
-	Ring2Utils::leftShiftAndEqual(spow, context.logq, context.qq, context.N);
-	NumUtils::sampleUniform2(ax, context.N, context.logqq);
-	NumUtils::sampleGauss(ex, context.N, context.sigma);
-	Ring2Utils::addAndEqual(ex, spow, context.qq, context.N);
-	Ring2Utils::mult(bx, secretKey.sx, ax, context.qq, context.N);
-	Ring2Utils::sub(bx, ex, bx, context.qq, context.N);
-	leftRotKeyMap.insert(pair<long, Key>(rot, Key(ax, bx)));
+	leftRotKeyMap.insert(pair<long, Key>(rot, generateSwitchKey(spow, secretKey.sx)));
 }
 
 void Scheme::addLeftRotKeys(SecretKey& secretKey) {
@@ -75,10 +86,74 @@ void Scheme::addRightRotKeys(SecretKey& secretKey) {
 	}
 }
 
-void Scheme::addBootKeys(SecretKey& secretKey, long lkey, long pBits) {
+void Scheme::addSparseKeys(SecretKey& secretKey, long sparseh) {
+	SecretKey sparseKey(context.N, sparseh);
+	keyMap.erase(SPARSE_ENCAPSULATION);
+	keyMap.insert(pair<long, Key>(SPARSE_ENCAPSULATION, generateSwitchKey(secretKey.sx, sparseKey.sx)));
+	keyMap.erase(SPARSE_DECAPSULATION);
+	keyMap.insert(pair<long, Key>(SPARSE_DECAPSULATION, generateSwitchKey(sparseKey.sx, secretKey.sx)));
+}
+
+long Scheme::sparseLogI(long sparseh) {
+	long logI = 1;
+	while ((1L << (2 * logI - 2)) < sparseh) {
+		logI++;
+	}
+	return logI;
+}
+
+void Scheme::addLazyBootKeys(SecretKey& secretKey, long lkey, long pBits) {
+	bootKeyMap.erase(lkey);
+	bootKeyMap.insert(pair<long, BootKey>(lkey, BootKey(context, pBits, lkey, &diagonalCache)));
+	diagonalCache.clear();
+	addBootKeys(secretKey, lkey, pBits);
+}
 
-	if(bootKeyMap.find(lkey) == bootKeyMap.end()) {
-		bootKeyMap.insert(pair<long, BootKey>(lkey, BootKey(context, pBits, lkey)));
+void Scheme::compressKeys() {
+	for (map<long, Key>::iterator it = keyMap.begin(); it != keyMap.end(); ++it) {
+		it->second.compress();
+	}
+	for (map<long, Key>::iterator it = leftRotKeyMap.begin(); it != leftRotKeyMap.end(); ++it) {
+		it->second.compress();
+	}
+}
+
+void Scheme::expandKeys() {
+	for (map<long, Key>::iterator it = keyMap.begin(); it != keyMap.end(); ++it) {
+		it->second.expand(context);
+	}
+	for (map<long, Key>::iterator it = leftRotKeyMap.begin(); it != leftRotKeyMap.end(); ++it) {
+		it->second.expand(context);
+	}
+}
+
+void Scheme::addBootKeys(SecretKey& secretKey, long lkey, long pBits, long levels, long sparseh) {
+	if(sparseh > 0) {
+		addSparseKeys(secretKey, sparseh);
+	}
+
+	if(bootKeyMap.find(lkey) == bootKeyMap.end() || bootKeyMap.at(lkey).levels != levels) {
+		bootKeyMap.erase(lkey);
+		bootKeyMap.insert(pair<long, BootKey>(lkey, BootKey(context, pBits, lkey, levels)));
+	}
+
+	if(levels > 0) {
+		BootKey& bootKey = bootKeyMap.at(lkey);
+		for (long i = 0; i < bootKey.levels; ++i) {
+			for (long j = 0; j < bootKey.ctsNum[i]; ++j) {
+				long idx = bootKey.ctsRot[i][j];
+				if(idx != 0 && leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
+					addLeftRotKey(secretKey, idx);
+				}
+			}
+			for (long j = 0; j < bootKey.stcNum[i]; ++j) {
+				long idx = bootKey.stcRot[i][j];
+				if(idx != 0 && leftRotKeyMap.find(idx) == leftRotKeyMap.end()) {
+					addLeftRotKey(secretKey, idx);
+				}
+			}
+		}
+		return;
 	}
 
 	long lkeyh = lkey/2;
@@ -99,6 +174,11 @@ void Scheme::addBootKeys(SecretKey& secretKey, long lkey, long pBits) {
 	}
 }
 
+void Scheme::addEvalModPlan(long logI, long logT, long precisionBits, long maxDegree) {
+	evalModPlanMap.erase(logI);
+	evalModPlanMap.insert(pair<long, EvalModPlan>(logI, EvalModPlan::plan(logI, logT, precisionBits, maxDegree)));
+}
+
 void Scheme::addSortKeys(SecretKey& secretKey, long size) {
 	for (long i = 1; i < size; ++i) {
 		if(leftRotKeyMap.find(i) == leftRotKeyMap.end()) {
@@ -110,25 +190,57 @@ void Scheme::addSortKeys(SecretKey& secretKey, long size) {
 Plaintext Scheme::encode(CZZ*& vals, long slots, long cbits, bool isComplex) {
 	long doubleslots = slots << 1;
 	ZZ mod = power2_ZZ(cbits);
-	CZZ* gvals = new CZZ[doubleslots];
-	for (long i = 0; i < slots; ++i) {
-		long idx = (context.rotGroup[i] % (slots << 2) - 1) / 2;
-		gvals[idx] = vals[i] << context.logq;
-		gvals[doubleslots - idx - 1] = vals[i].conjugate() << context.logq;
-	}
 
 	ZZX mx;
 	mx.SetLength(context.N);
 	long idx = 0;
 	long gap = context.N / doubleslots;
 
-	NumUtils::fftSpecialInv(gvals, doubleslots, context.ksiPowsr, context.ksiPowsi, context.M);
+	long bits = 0;
+	for (long i = 0; i < slots; ++i) {
+		bits = max(bits, max(NumBits(vals[i].r), NumBits(vals[i].i)));
+	}
 
-	for (long i = 0; i < doubleslots; ++i) {
-		mx.rep[idx] = gvals[i].r;
-		idx += gap;
+	if(bits <= FFT_DOUBLE_BITS) {
+		complex<double>* dvals = new complex<double>[doubleslots];
+		for (long i = 0; i < slots; ++i) {
+			long jdx = (context.rotGroup[i] % (slots << 2) - 1) / 2;
+			dvals[jdx] = complex<double>(to_double(vals[i].r), to_double(vals[i].i));
+			dvals[doubleslots - jdx - 1] = conj(dvals[jdx]);
+		}
+		NumUtils::fftSpecialInv(dvals, doubleslots, context.ksiPowsDouble, context.M);
+		for (long i = 0; i < doubleslots; ++i) {
+			mx.rep[idx] = EvaluatorUtils::evalZZ(dvals[i].real(), context.logq);
+			idx += gap;
+		}
+		delete[] dvals;
+	} else if(bits <= FFT_LONG_DOUBLE_BITS) {
+		complex<long double>* ldvals = new complex<long double>[doubleslots];
+		for (long i = 0; i < slots; ++i) {
+			long jdx = (context.rotGroup[i] % (slots << 2) - 1) / 2;
+			ldvals[jdx] = complex<long double>(EvaluatorUtils::evalLongDouble(vals[i].r), EvaluatorUtils::evalLongDouble(vals[i].i));
+			ldvals[doubleslots - jdx - 1] = conj(ldvals[jdx]);
+		}
+		NumUtils::fftSpecialInv(ldvals, doubleslots, context.ksiPowsLongDouble, context.M);
+		for (long i = 0; i < doubleslots; ++i) {
+			mx.rep[idx] = EvaluatorUtils::evalZZ(ldvals[i].real(), context.logq);
+			idx += gap;
+		}
+		delete[] ldvals;
+	} else {
+		CZZ* gvals = new CZZ[doubleslots];
+		for (long i = 0; i < slots; ++i) {
+			long jdx = (context.rotGroup[i] % (slots << 2) - 1) / 2;
+			gvals[jdx] = vals[i] << context.logq;
+			gvals[doubleslots - jdx - 1] = vals[i].conjugate() << context.logq;
+		}
+		NumUtils::fftSpecialInv(gvals, doubleslots, context.ksiPowsr, context.ksiPowsi, context.M);
+		for (long i = 0; i < doubleslots; ++i) {
+			mx.rep[idx] = gvals[i].r;
+			idx += gap;
+		}
+		delete[] gvals;
 	}
-	delete[] gvals;
 	return Plaintext(mx, mod, cbits, slots, isComplex);
 }
 
@@ -138,13 +250,39 @@ CZZ* Scheme::decode(Plaintext& msg) {
 
 	long idx = 0;
 	long gap = context.N / doubleslots;
+	long bits = 0;
 	for (long i = 0; i < doubleslots; ++i) {
 		ZZ tmp = msg.mx.rep[idx] % msg.mod;
 		if(NumBits(tmp) == msg.cbits) tmp -= msg.mod;
 		fftinv[i] = CZZ(tmp, ZZ(0));
+		bits = max(bits, NumBits(tmp));
 		idx += gap;
 	}
-	NumUtils::fftSpecial(fftinv, doubleslots, context.ksiPowsr, context.ksiPowsi, context.M);
+	bits += log2(doubleslots);
+
+	if(bits <= FFT_DOUBLE_BITS) {
+		complex<double>* dvals = new complex<double>[doubleslots];
+		for (long i = 0; i < doubleslots; ++i) {
+			dvals[i] = to_double(fftinv[i].r);
+		}
+		NumUtils::fftSpecial(dvals, doubleslots, context.ksiPowsDouble, context.M);
+		for (long i = 0; i < doubleslots; ++i) {
+			fftinv[i] = EvaluatorUtils::evalCZZ(dvals[i].real(), dvals[i].imag(), 0);
+		}
+		delete[] dvals;
+	} else if(bits <= FFT_LONG_DOUBLE_BITS) {
+		complex<long double>* ldvals = new complex<long double>[doubleslots];
+		for (long i = 0; i < doubleslots; ++i) {
+			ldvals[i] = EvaluatorUtils::evalLongDouble(fftinv[i].r);
+		}
+		NumUtils::fftSpecial(ldvals, doubleslots, context.ksiPowsLongDouble, context.M);
+		for (long i = 0; i < doubleslots; ++i) {
+			fftinv[i] = CZZ(EvaluatorUtils::evalZZ(ldvals[i].real(), 0), EvaluatorUtils::evalZZ(ldvals[i].imag(), 0));
+		}
+		delete[] ldvals;
+	} else {
+		NumUtils::fftSpecial(fftinv, doubleslots, context.ksiPowsr, context.ksiPowsi, context.M);
+	}
 	CZZ* res = new CZZ[msg.slots];
 	for (long i = 0; i < msg.slots; ++i) {
 		long idx = (context.rotGroup[i] % (msg.slots << 2) - 1) / 2;
@@ -182,15 +320,15 @@ CZZ Scheme::decodeSingle(Plaintext& msg) {
 Ciphertext Scheme::encryptMsg(Plaintext& msg) {
 	ZZX ax, bx, vx, eax, ebx;
 	NumUtils::sampleZO(vx, context.N);
-	Key key = keyMap.at(ENCRYPTION);
+	Key& key = keyMap.at(ENCRYPTION);
 
 	ZZ Pmod = msg.mod << context.logq;
 
-	Ring2Utils::mult(ax, vx, key.ax, Pmod, context.N);
+	Ring2Utils::mult(ax, vx, key.ax, Pmod, context.N, context.multiplier);
 	NumUtils::sampleGauss(eax, context.N, context.sigma);
 	Ring2Utils::addAndEqual(ax, eax, Pmod, context.N);
 
-	Ring2Utils::mult(bx, vx, key.bx, Pmod, context.N);
+	Ring2Utils::mult(bx, vx, key.bx, Pmod, context.N, context.multiplier);
 	NumUtils::sampleGauss(ebx, context.N, context.sigma);
 	Ring2Utils::addAndEqual(bx, ebx, Pmod, context.N);
 
@@ -204,7 +342,7 @@ Ciphertext Scheme::encryptMsg(Plaintext& msg) {
 
 Plaintext Scheme::decryptMsg(SecretKey& secretKey, Ciphertext& cipher) {
 	ZZX mx;
-	Ring2Utils::mult(mx, cipher.ax, secretKey.sx, cipher.mod, context.N);
+	Ring2Utils::mult(mx, cipher.ax, secretKey.sx, cipher.mod, context.N, context.multiplier);
 	Ring2Utils::addAndEqual(mx, cipher.bx, cipher.mod, context.N);
 	return Plaintext(mx, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
 }
@@ -289,44 +427,34 @@ void Scheme::subAndEqual2(Ciphertext& cipher1, Ciphertext& cipher2) {
 }
 
 Ciphertext Scheme::conjugate(Ciphertext& cipher) {
-	ZZ Pmod = cipher.mod << context.logq;
-
-	ZZX bxconj, bxres, axres;
+	ScratchArena::Frame frame;
+	ZZX& bxconj = frame.poly();
+	ZZX bxres, axres;
 
 	Ring2Utils::conjugate(bxconj, cipher.bx, context.N);
 	Ring2Utils::conjugate(bxres, cipher.ax, context.N);
 
-	Key key = keyMap.at(CONJUGATION);
-
-	Ring2Utils::mult(axres, bxres, key.ax, Pmod, context.N);
-	Ring2Utils::multAndEqual(bxres, key.bx, Pmod, context.N);
-
-	Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+	switchKey(axres, bxres, bxres, keyMap.at(CONJUGATION), cipher.mod);
 
 	Ring2Utils::addAndEqual(bxres, bxconj, cipher.mod, context.N);
 	return Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::conjugateAndEqual(Ciphertext& cipher) {
-	ZZ Pmod = cipher.mod << context.logq;
-
-	ZZX bxconj, bxres, axres;
+	ScratchArena::Frame frame;
+	ZZX& bxconj = frame.poly();
+	ZZX& bxres = frame.poly();
+	ZZX& axres = frame.poly();
 
 	Ring2Utils::conjugate(bxconj, cipher.bx, context.N);
 	Ring2Utils::conjugate(bxres, cipher.ax, context.N);
 
-	Key key = keyMap.at(CONJUGATION);
-	Ring2Utils::mult(axres, bxres, key.ax, Pmod, context.N);
-	Ring2Utils::multAndEqual(bxres, key.bx, Pmod, context.N);
-
-	Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+	switchKey(axres, bxres, bxres, keyMap.at(CONJUGATION), cipher.mod);
 
 	Ring2Utils::addAndEqual(bxres, bxconj, cipher.mod, context.N);
 
-	cipher.ax = axres;
-	cipher.bx = bxres;
+	swap(cipher.ax, axres);
+	swap(cipher.bx, bxres);
 }
 
 Ciphertext Scheme::imult(Ciphertext& cipher, const long precisionBits) {
@@ -342,23 +470,16 @@ void Scheme::imultAndEqual(Ciphertext& cipher, const long precisionBits) {
 }
 
 Ciphertext Scheme::mult(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ Pmod = cipher1.mod << context.logq;
-
-	ZZX axbx1 = Ring2Utils::add(cipher1.ax, cipher1.bx, cipher1.mod, context.N);
-	ZZX axbx2 = Ring2Utils::add(cipher2.ax, cipher2.bx, cipher1.mod, context.N);
-	Ring2Utils::multAndEqual(axbx1, axbx2, cipher1.mod, context.N);
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
 
-	ZZX bxbx = Ring2Utils::mult(cipher1.bx, cipher2.bx, cipher1.mod, context.N);
-	ZZX axax = Ring2Utils::mult(cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	ZZX axmult, bxmult;
+	switchKey(axmult, bxmult, axax, keyMap.at(MULTIPLICATION), cipher1.mod);
 
-	Key key = keyMap.at(MULTIPLICATION);
-	ZZX axmult = Ring2Utils::mult(axax, key.ax, Pmod, context.N);
-	ZZX bxmult = Ring2Utils::mult(axax, key.bx, Pmod, context.N);
-
-	Ring2Utils::rightShiftAndEqual(axmult, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxmult, context.logq, context.N);
-
-	Ring2Utils::addAndEqual(axmult, axbx1, cipher1.mod, context.N);
+	Ring2Utils::addAndEqual(axmult, axbx, cipher1.mod, context.N);
 	Ring2Utils::subAndEqual(axmult, bxbx, cipher1.mod, context.N);
 	Ring2Utils::subAndEqual(axmult, axax, cipher1.mod, context.N);
 	Ring2Utils::addAndEqual(bxmult, bxbx, cipher1.mod, context.N);
@@ -367,23 +488,15 @@ Ciphertext Scheme::mult(Ciphertext& cipher1, Ciphertext& cipher2) {
 }
 
 void Scheme::multAndEqual(Ciphertext& cipher1, Ciphertext& cipher2) {
-	ZZ Pmod = cipher1.mod << context.logq;
-
-	ZZX axbx1 = Ring2Utils::add(cipher1.ax, cipher1.bx, cipher1.mod, context.N);
-	ZZX axbx2 = Ring2Utils::add(cipher2.ax, cipher2.bx, cipher1.mod, context.N);
-	Ring2Utils::multAndEqual(axbx1, axbx2, cipher1.mod, context.N);
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
 
-	ZZX bxbx = Ring2Utils::mult(cipher1.bx, cipher2.bx, cipher1.mod, context.N);
-	ZZX axax = Ring2Utils::mult(cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	switchKey(cipher1.ax, cipher1.bx, axax, keyMap.at(MULTIPLICATION), cipher1.mod);
 
-	Key key = keyMap.at(MULTIPLICATION);
-	cipher1.ax = Ring2Utils::mult(axax, key.ax, Pmod, context.N);
-	cipher1.bx = Ring2Utils::mult(axax, key.bx, Pmod, context.N);
-
-	Ring2Utils::rightShiftAndEqual(cipher1.ax, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher1.bx, context.logq, context.N);
-
-	Ring2Utils::addAndEqual(cipher1.ax, axbx1, cipher1.mod, context.N);
+	Ring2Utils::addAndEqual(cipher1.ax, axbx, cipher1.mod, context.N);
 	Ring2Utils::subAndEqual(cipher1.ax, bxbx, cipher1.mod, context.N);
 	Ring2Utils::subAndEqual(cipher1.ax, axax, cipher1.mod, context.N);
 	Ring2Utils::addAndEqual(cipher1.bx, bxbx, cipher1.mod, context.N);
@@ -392,21 +505,14 @@ void Scheme::multAndEqual(Ciphertext& cipher1, Ciphertext& cipher2) {
 //-----------------------------------------
 
 Ciphertext Scheme::square(Ciphertext& cipher) {
-	ZZ Pmod = cipher.mod << context.logq;
-
-	ZZX axax, axbx, bxbx, bxmult, axmult;
-
-	Ring2Utils::square(bxbx, cipher.bx, cipher.mod, context.N);
-	Ring2Utils::mult(axbx, cipher.ax, cipher.bx, cipher.mod, context.N);
-	Ring2Utils::addAndEqual(axbx, axbx, cipher.mod, context.N);
-	Ring2Utils::square(axax, cipher.ax, cipher.mod, context.N);
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	squareProducts(axbx, bxbx, axax, cipher);
 
-	Key key = keyMap.at(MULTIPLICATION);
-	Ring2Utils::mult(axmult, axax, key.ax, Pmod, context.N);
-	Ring2Utils::mult(bxmult, axax, key.bx, Pmod, context.N);
-
-	Ring2Utils::rightShiftAndEqual(axmult, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxmult, context.logq, context.N);
+	ZZX axmult, bxmult;
+	switchKey(axmult, bxmult, axax, keyMap.at(MULTIPLICATION), cipher.mod);
 
 	Ring2Utils::addAndEqual(axmult, axbx, cipher.mod, context.N);
 	Ring2Utils::addAndEqual(bxmult, bxbx, cipher.mod, context.N);
@@ -415,27 +521,233 @@ Ciphertext Scheme::square(Ciphertext& cipher) {
 }
 
 void Scheme::squareAndEqual(Ciphertext& cipher) {
-	ZZ Pmod = cipher.mod << context.logq;
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	squareProducts(axbx, bxbx, axax, cipher);
+
+	switchKey(cipher.ax, cipher.bx, axax, keyMap.at(MULTIPLICATION), cipher.mod);
+
+	Ring2Utils::addAndEqual(cipher.ax, axbx, cipher.mod, context.N);
+	Ring2Utils::addAndEqual(cipher.bx, bxbx, cipher.mod, context.N);
+}
+
+//-----------------------------------------
 
-	ZZX bxbx, axbx, axax, bxmult, axmult;
+Ciphertext3 Scheme::multNoRelin(Ciphertext& cipher1, Ciphertext& cipher2) {
+	ZZX axbx, bxbx, axax;
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
+
+	Ring2Utils::subAndEqual(axbx, bxbx, cipher1.mod, context.N);
+	Ring2Utils::subAndEqual(axbx, axax, cipher1.mod, context.N);
+
+	return Ciphertext3(axbx, bxbx, axax, cipher1.mod, cipher1.cbits, cipher1.slots, cipher1.isComplex);
+}
+
+Ciphertext3 Scheme::squareNoRelin(Ciphertext& cipher) {
+	ZZX axbx, bxbx, axax;
+	squareProducts(axbx, bxbx, axax, cipher);
+
+	return Ciphertext3(axbx, bxbx, axax, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
+}
 
-	Ring2Utils::square(bxbx, cipher.bx, cipher.mod, context.N);
-	Ring2Utils::mult(axbx, cipher.bx, cipher.ax, cipher.mod, context.N);
+Ciphertext3 Scheme::add(Ciphertext3& cipher1, Ciphertext3& cipher2) {
+	ZZX ax, bx, axax;
+
+	Ring2Utils::add(ax, cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	Ring2Utils::add(bx, cipher1.bx, cipher2.bx, cipher1.mod, context.N);
+	Ring2Utils::add(axax, cipher1.axax, cipher2.axax, cipher1.mod, context.N);
+
+	return Ciphertext3(ax, bx, axax, cipher1.mod, cipher1.cbits, cipher1.slots, cipher1.isComplex);
+}
+
+void Scheme::addAndEqual(Ciphertext3& cipher1, Ciphertext3& cipher2) {
+	Ring2Utils::addAndEqual(cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	Ring2Utils::addAndEqual(cipher1.bx, cipher2.bx, cipher1.mod, context.N);
+	Ring2Utils::addAndEqual(cipher1.axax, cipher2.axax, cipher1.mod, context.N);
+}
+
+void Scheme::addAndEqual(Ciphertext3& cipher1, Ciphertext& cipher2) {
+	Ring2Utils::addAndEqual(cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	Ring2Utils::addAndEqual(cipher1.bx, cipher2.bx, cipher1.mod, context.N);
+}
+
+Ciphertext3 Scheme::sub(Ciphertext3& cipher1, Ciphertext3& cipher2) {
+	ZZX ax, bx, axax;
+
+	Ring2Utils::sub(ax, cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	Ring2Utils::sub(bx, cipher1.bx, cipher2.bx, cipher1.mod, context.N);
+	Ring2Utils::sub(axax, cipher1.axax, cipher2.axax, cipher1.mod, context.N);
+
+	return Ciphertext3(ax, bx, axax, cipher1.mod, cipher1.cbits, cipher1.slots, cipher1.isComplex);
+}
+
+void Scheme::subAndEqual(Ciphertext3& cipher1, Ciphertext3& cipher2) {
+	Ring2Utils::subAndEqual(cipher1.ax, cipher2.ax, cipher1.mod, context.N);
+	Ring2Utils::subAndEqual(cipher1.bx, cipher2.bx, cipher1.mod, context.N);
+	Ring2Utils::subAndEqual(cipher1.axax, cipher2.axax, cipher1.mod, context.N);
+}
+
+Ciphertext Scheme::relinearize(Ciphertext3& cipher) {
+	ZZX axres, bxres;
+	switchKey(axres, bxres, cipher.axax, keyMap.at(MULTIPLICATION), cipher.mod);
+
+	Ring2Utils::addAndEqual(axres, cipher.ax, cipher.mod, context.N);
+	Ring2Utils::addAndEqual(bxres, cipher.bx, cipher.mod, context.N);
+
+	return Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
+}
+
+//-----------------------------------------
+
+void Scheme::multProducts(ZZX& axbx, ZZX& bxbx, ZZX& axax, Ciphertext& cipher1, Ciphertext& cipher2) {
+	ScratchArena::Frame frame;
+	ZZX& axbx2 = frame.poly();
+	Ring2Utils::add(axbx, cipher1.ax, cipher1.bx, cipher1.mod, context.N);
+	Ring2Utils::add(axbx2, cipher2.ax, cipher2.bx, cipher1.mod, context.N);
+
+	NTL_EXEC_RANGE(3, first, last);
+	for (long index = first; index < last; ++index) {
+		if(index == 0) {
+			Ring2Utils::multAndEqual(axbx, axbx2, cipher1.mod, context.N, context.multiplier);
+		} else if(index == 1) {
+			Ring2Utils::mult(bxbx, cipher1.bx, cipher2.bx, cipher1.mod, context.N, context.multiplier);
+		} else {
+			Ring2Utils::mult(axax, cipher1.ax, cipher2.ax, cipher1.mod, context.N, context.multiplier);
+		}
+	}
+	NTL_EXEC_RANGE_END;
+}
+
+void Scheme::squareProducts(ZZX& axbx, ZZX& bxbx, ZZX& axax, Ciphertext& cipher) {
+	NTL_EXEC_RANGE(3, first, last);
+	for (long index = first; index < last; ++index) {
+		if(index == 0) {
+			Ring2Utils::square(bxbx, cipher.bx, cipher.mod, context.N, context.multiplier);
+		} else if(index == 1) {
+			Ring2Utils::mult(axbx, cipher.ax, cipher.bx, cipher.mod, context.N, context.multiplier);
+		} else {
+			Ring2Utils::square(axax, cipher.ax, cipher.mod, context.N, context.multiplier);
+		}
+	}
+	NTL_EXEC_RANGE_END;
 	Ring2Utils::addAndEqual(axbx, axbx, cipher.mod, context.N);
-	Ring2Utils::square(axax, cipher.ax, cipher.mod, context.N);
+}
 
-	Key key = keyMap.at(MULTIPLICATION);
-	Ring2Utils::mult(axmult, axax, key.ax, Pmod, context.N);
-	Ring2Utils::mult(bxmult, axax, key.bx, Pmod, context.N);
+void Scheme::combineAndRescale(ZZX& axres, ZZX& bxres, ZZX& axbx, ZZX& bxbx, ZZX& axax, bool isSquare, ZZ& mod, long bitsDown) {
+	ZZ half;
+	if(bitsDown > 0) power2(half, bitsDown - 1);
+	for (long i = 0; i < context.N; ++i) {
+		ZZ& ax = axres.rep[i];
+		AddMod(ax, ax, axbx.rep[i], mod);
+		if(!isSquare) {
+			NTL::sub(ax, ax, bxbx.rep[i]);
+			if(ax >= mod) ax -= mod;
+			NTL::sub(ax, ax, axax.rep[i]);
+			if(ax >= mod) ax -= mod;
+		}
+		reScaleCoeff(ax, bitsDown, half);
+
+		ZZ& bx = bxres.rep[i];
+		AddMod(bx, bx, bxbx.rep[i], mod);
+		reScaleCoeff(bx, bitsDown, half);
+	}
+}
 
-	Ring2Utils::rightShiftAndEqual(axmult, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxmult, context.logq, context.N);
+void Scheme::reScaleCoeff(ZZ& x, long bitsDown, ZZ& half) {
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRound(x, half, bitsDown);
+	} else {
+		x >>= bitsDown;
+	}
+}
 
-	Ring2Utils::addAndEqual(axmult, axbx, cipher.mod, context.N);
-	Ring2Utils::addAndEqual(bxmult, bxbx, cipher.mod, context.N);
+Ciphertext Scheme::multAndRescale(Ciphertext& cipher1, Ciphertext& cipher2, long bitsDown) {
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
+
+	ZZX axmult, bxmult;
+	switchKey(axmult, bxmult, axax, keyMap.at(MULTIPLICATION), cipher1.mod);
+	combineAndRescale(axmult, bxmult, axbx, bxbx, axax, false, cipher1.mod, bitsDown);
+
+	ZZ newmod = cipher1.mod >> bitsDown;
+	return Ciphertext(axmult, bxmult, newmod, cipher1.cbits - bitsDown, cipher1.slots, cipher1.isComplex);
+}
+
+void Scheme::multAndRescaleAndEqual(Ciphertext& cipher1, Ciphertext& cipher2, long bitsDown) {
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
+
+	switchKey(cipher1.ax, cipher1.bx, axax, keyMap.at(MULTIPLICATION), cipher1.mod);
+	combineAndRescale(cipher1.ax, cipher1.bx, axbx, bxbx, axax, false, cipher1.mod, bitsDown);
+
+	cipher1.cbits -= bitsDown;
+	cipher1.mod >>= bitsDown;
+}
+
+Ciphertext Scheme::squareAndRescale(Ciphertext& cipher, long bitsDown) {
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	squareProducts(axbx, bxbx, axax, cipher);
+
+	ZZX axmult, bxmult;
+	switchKey(axmult, bxmult, axax, keyMap.at(MULTIPLICATION), cipher.mod);
+	combineAndRescale(axmult, bxmult, axbx, bxbx, axax, true, cipher.mod, bitsDown);
+
+	ZZ newmod = cipher.mod >> bitsDown;
+	return Ciphertext(axmult, bxmult, newmod, cipher.cbits - bitsDown, cipher.slots, cipher.isComplex);
+}
+
+void Scheme::squareAndRescaleAndEqual(Ciphertext& cipher, long bitsDown) {
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	squareProducts(axbx, bxbx, axax, cipher);
+
+	switchKey(cipher.ax, cipher.bx, axax, keyMap.at(MULTIPLICATION), cipher.mod);
+	combineAndRescale(cipher.ax, cipher.bx, axbx, bxbx, axax, true, cipher.mod, bitsDown);
+
+	cipher.cbits -= bitsDown;
+	cipher.mod >>= bitsDown;
+}
 
-	cipher.bx = bxmult;
-	cipher.ax = axmult;
+void Scheme::multAcc(Ciphertext& acc, Ciphertext& cipher1, Ciphertext& cipher2) {
+	if(acc.cbits != cipher1.cbits || acc.mod != cipher1.mod || acc.slots != cipher1.slots) {
+		throw invalid_argument("accumulator is at another level than product");
+	}
+	ScratchArena::Frame frame;
+	ZZX& axbx = frame.poly();
+	ZZX& bxbx = frame.poly();
+	ZZX& axax = frame.poly();
+	ZZX& axmult = frame.poly();
+	ZZX& bxmult = frame.poly();
+	multProducts(axbx, bxbx, axax, cipher1, cipher2);
+
+	ZZ& mod = cipher1.mod;
+	switchKey(axmult, bxmult, axax, keyMap.at(MULTIPLICATION), mod);
+	for (long i = 0; i < context.N; ++i) {
+		ZZ& ax = axmult.rep[i];
+		AddMod(ax, ax, axbx.rep[i], mod);
+		NTL::sub(ax, ax, bxbx.rep[i]);
+		if(ax >= mod) ax -= mod;
+		NTL::sub(ax, ax, axax.rep[i]);
+		if(ax >= mod) ax -= mod;
+		AddMod(acc.ax.rep[i], acc.ax.rep[i], ax, mod);
+
+		ZZ& bx = bxmult.rep[i];
+		AddMod(bx, bx, bxbx.rep[i], mod);
+		AddMod(acc.bx.rep[i], acc.bx.rep[i], bx, mod);
+	}
 }
 
 //-----------------------------------------
@@ -453,16 +765,58 @@ void Scheme::multByConstAndEqual(Ciphertext& cipher, ZZ& cnst) {
 	Ring2Utils::multByConstAndEqual(cipher.bx, cnst, cipher.mod, context.N);
 }
 
+Ciphertext Scheme::multByConstAndRescale(Ciphertext& cipher, ZZ& cnst, long bitsDown) {
+	ZZX ax, bx;
+	ax.SetLength(context.N);
+	bx.SetLength(context.N);
+	ZZ half;
+	if(bitsDown > 0) power2(half, bitsDown - 1);
+	for (long i = 0; i < context.N; ++i) {
+		MulMod(ax.rep[i], cipher.ax.rep[i], cnst, cipher.mod);
+		reScaleCoeff(ax.rep[i], bitsDown, half);
+		MulMod(bx.rep[i], cipher.bx.rep[i], cnst, cipher.mod);
+		reScaleCoeff(bx.rep[i], bitsDown, half);
+	}
+
+	ZZ newmod = cipher.mod >> bitsDown;
+	return Ciphertext(ax, bx, newmod, cipher.cbits - bitsDown, cipher.slots, cipher.isComplex);
+}
+
+void Scheme::multByConstAndRescaleAndEqual(Ciphertext& cipher, ZZ& cnst, long bitsDown) {
+	ZZ half;
+	if(bitsDown > 0) power2(half, bitsDown - 1);
+	for (long i = 0; i < context.N; ++i) {
+		MulMod(cipher.ax.rep[i], cipher.ax.rep[i], cnst, cipher.mod);
+		reScaleCoeff(cipher.ax.rep[i], bitsDown, half);
+		MulMod(cipher.bx.rep[i], cipher.bx.rep[i], cnst, cipher.mod);
+		reScaleCoeff(cipher.bx.rep[i], bitsDown, half);
+	}
+	cipher.cbits -= bitsDown;
+	cipher.mod >>= bitsDown;
+}
+
 Ciphertext Scheme::multByPoly(Ciphertext& cipher, ZZX& poly) {
 	ZZX axres, bxres;
-	Ring2Utils::mult(axres, cipher.ax, poly, cipher.mod, context.N);
-	Ring2Utils::mult(bxres, cipher.bx, poly, cipher.mod, context.N);
+	Ring2Utils::mult(axres, cipher.ax, poly, cipher.mod, context.N, context.multiplier);
+	Ring2Utils::mult(bxres, cipher.bx, poly, cipher.mod, context.N, context.multiplier);
 	return Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::multByPolyAndEqual(Ciphertext& cipher, ZZX& poly) {
-	Ring2Utils::multAndEqual(cipher.ax, poly, cipher.mod, context.N);
-	Ring2Utils::multAndEqual(cipher.bx, poly, cipher.mod, context.N);
+	Ring2Utils::multAndEqual(cipher.ax, poly, cipher.mod, context.N, context.multiplier);
+	Ring2Utils::multAndEqual(cipher.bx, poly, cipher.mod, context.N, context.multiplier);
+}
+
+Ciphertext Scheme::multByPoly(Ciphertext& cipher, SparsePoly& poly) {
+	ZZX axres, bxres;
+	Ring2Utils::multBySparse(axres, cipher.ax, poly, cipher.mod, context.N, context.multiplier);
+	Ring2Utils::multBySparse(bxres, cipher.bx, poly, cipher.mod, context.N, context.multiplier);
+	return Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
+}
+
+void Scheme::multByPolyAndEqual(Ciphertext& cipher, SparsePoly& poly) {
+	Ring2Utils::multBySparse(cipher.ax, cipher.ax, poly, cipher.mod, context.N, context.multiplier);
+	Ring2Utils::multBySparse(cipher.bx, cipher.bx, poly, cipher.mod, context.N, context.multiplier);
 }
 
 //-----------------------------------------
@@ -507,8 +861,13 @@ void Scheme::doubleAndEqual(Ciphertext& cipher) {
 Ciphertext Scheme::reScaleBy(Ciphertext& cipher, long bitsDown) {
 	ZZX ax, bx;
 
-	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRound(ax, cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftRound(bx, cipher.bx, bitsDown, context.N);
+	} else {
+		Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	}
 
 	long newcbits = cipher.cbits - bitsDown;
 	ZZ newmod = cipher.mod >> bitsDown;
@@ -519,24 +878,39 @@ Ciphertext Scheme::reScaleTo(Ciphertext& cipher, long newcbits) {
 	ZZX ax, bx;
 
 	long bitsDown = cipher.cbits - newcbits;
-	Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRound(ax, cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftRound(bx, cipher.bx, bitsDown, context.N);
+	} else {
+		Ring2Utils::rightShift(ax, cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShift(bx, cipher.bx, bitsDown, context.N);
+	}
 
 	ZZ newmod = power2_ZZ(newcbits);
 	return Ciphertext(ax, bx, newmod, newcbits, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::reScaleByAndEqual(Ciphertext& cipher, long bitsDown) {
-	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRoundAndEqual(cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftRoundAndEqual(cipher.bx, bitsDown, context.N);
+	} else {
+		Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	}
 	cipher.cbits -= bitsDown;
 	cipher.mod >>= bitsDown;
 }
 
 void Scheme::reScaleToAndEqual(Ciphertext& cipher, long newcbits) {
 	long bitsDown = cipher.cbits - newcbits;
-	Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
-	Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRoundAndEqual(cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftRoundAndEqual(cipher.bx, bitsDown, context.N);
+	} else {
+		Ring2Utils::rightShiftAndEqual(cipher.ax, bitsDown, context.N);
+		Ring2Utils::rightShiftAndEqual(cipher.bx, bitsDown, context.N);
+	}
 	cipher.cbits = newcbits;
 	cipher.mod = power2_ZZ(newcbits);
 }
@@ -578,46 +952,245 @@ void Scheme::modDownToAndEqual(Ciphertext& cipher, long newcbits) {
 	Ring2Utils::modAndEqual(cipher.bx, cipher.mod, context.N);
 }
 
-Ciphertext Scheme::leftRotateFast(Ciphertext& cipher, long rotSlots) {
-	ZZ Pmod = cipher.mod << context.logq;
+//-----------------------------------------
 
-	ZZX bxrot, bxres, axres;
+PackedCiphertext Scheme::pack(Ciphertext& cipher) {
+	PackedCiphertext res(context.N, cipher.cbits, cipher.slots, cipher.isComplex);
+	Ring2Utils::toLimbs(res.ax, cipher.ax, cipher.cbits, context.N);
+	Ring2Utils::toLimbs(res.bx, cipher.bx, cipher.cbits, context.N);
+	return res;
+}
 
-	Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], context.q, context.N);
-	Ring2Utils::inpower(bxres, cipher.ax, context.rotGroup[rotSlots], context.q, context.N);
+Ciphertext Scheme::unpack(PackedCiphertext& cipher) {
+	ZZX ax, bx;
+	Ring2Utils::fromLimbs(ax, cipher.ax, cipher.limbs, context.N);
+	Ring2Utils::fromLimbs(bx, cipher.bx, cipher.limbs, context.N);
+	return Ciphertext(ax, bx, power2_ZZ(cipher.cbits), cipher.cbits, cipher.slots, cipher.isComplex);
+}
 
-	Key key = leftRotKeyMap.at(rotSlots);
+void Scheme::addAndEqual(PackedCiphertext& cipher1, PackedCiphertext& cipher2) {
+	Ring2Utils::addLimbsAndEqual(cipher1.ax, cipher2.ax, cipher1.cbits, context.N);
+	Ring2Utils::addLimbsAndEqual(cipher1.bx, cipher2.bx, cipher1.cbits, context.N);
+}
 
-	Ring2Utils::mult(axres, bxres, key.ax, Pmod, context.N);
-	Ring2Utils::multAndEqual(bxres, key.bx, Pmod, context.N);
+void Scheme::subAndEqual(PackedCiphertext& cipher1, PackedCiphertext& cipher2) {
+	Ring2Utils::subLimbsAndEqual(cipher1.ax, cipher2.ax, cipher1.cbits, context.N);
+	Ring2Utils::subLimbsAndEqual(cipher1.bx, cipher2.bx, cipher1.cbits, context.N);
+}
 
-	Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+void Scheme::reScaleByAndEqual(PackedCiphertext& cipher, long bitsDown) {
+	if(rescaleMode == RESCALE_ROUND) {
+		Ring2Utils::rightShiftRoundLimbsAndEqual(cipher.ax, cipher.cbits, bitsDown, context.N);
+		Ring2Utils::rightShiftRoundLimbsAndEqual(cipher.bx, cipher.cbits, bitsDown, context.N);
+	} else {
+		Ring2Utils::rightShiftLimbsAndEqual(cipher.ax, cipher.cbits, bitsDown, context.N);
+		Ring2Utils::rightShiftLimbsAndEqual(cipher.bx, cipher.cbits, bitsDown, context.N);
+	}
+	cipher.cbits -= bitsDown;
+	cipher.limbs = PackedCiphertext::numLimbs(cipher.cbits);
+}
+
+void Scheme::switchKeyAndEqual(Ciphertext& cipher, Key& key) {
+	ScratchArena::Frame frame;
+	ZZX& axres = frame.poly();
+	ZZX& bxres = frame.poly();
+
+	switchKey(axres, bxres, cipher.ax, key, cipher.mod);
+
+	Ring2Utils::addAndEqual(bxres, cipher.bx, cipher.mod, context.N);
+
+	swap(cipher.ax, axres);
+	swap(cipher.bx, bxres);
+}
+
+void Scheme::switchKey(ZZX& axres, ZZX& bxres, ZZX& p, Key& key, ZZ& mod) {
+	shared_ptr<Key> levelKey = useLevelKeys ? key.atLevel(context, NumBits(mod) - 1) : shared_ptr<Key>();
+	Key& k = levelKey ? *levelKey : key;
+	ScratchArena::Frame frame;
+	ZZ& Pmod = frame.number();
+	if(!k.isHybrid()) {
+		LeftShift(Pmod, mod, context.logq);
+		Ring2Utils::multByKey(axres, bxres, p, k, Pmod, context.N, context.multiplier);
+		Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
+		Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+		return;
+	}
+	long logMod = NumBits(mod) - 1;
+	long num = min(k.dnum, (logMod + k.logP - 1) / k.logP);
+	LeftShift(Pmod, mod, k.logP);
+
+	RingMultiplier* multiplier = context.multiplier;
+	long np = -1;
+	if(multiplier != NULL && multiplier->N == context.N) {
+		long bits = 0;
+		for (long i = 0; i < num; ++i) {
+			bits = max(bits, k.digits[i].bits);
+		}
+		np = multiplier->numPrimes(k.logP + bits + NumBits(num) + context.logN);
+		for (long i = 0; i < num && np > 0; ++i) {
+			if(!k.digits[i].rax || k.digits[i].np < np) np = -1;
+		}
+	}
+
+	ZZX& px = frame.poly();
+	ZZX& digit = frame.poly();
+	ZZX& axdigit = frame.poly();
+	ZZX& bxdigit = frame.poly();
+	long len = max(np, 1L) << context.logN;
+	uint64_t* rdigit = np > 0 ? frame.words(len) : NULL;
+	uint64_t* raxres = np > 0 ? frame.words(len) : NULL;
+	uint64_t* rbxres = np > 0 ? frame.words(len) : NULL;
+	Ring2Utils::mod(px, p, mod, context.N);
+	digit.SetLength(context.N);
+	for (long i = 0; i < num; ++i) {
+		for (long j = 0; j < context.N; ++j) {
+			RightShift(digit.rep[j], px.rep[j], k.logP * i);
+			trunc(digit.rep[j], digit.rep[j], k.logP);
+		}
+		if(np > 0) {
+			multiplier->toNTT(rdigit, digit, np);
+			if(i == 0) {
+				multiplier->multResidues(raxres, rdigit, k.digits[i].rax.get(), np);
+				multiplier->multResidues(rbxres, rdigit, k.digits[i].rbx.get(), np);
+			} else {
+				multiplier->multAddResidues(raxres, rdigit, k.digits[i].rax.get(), np);
+				multiplier->multAddResidues(rbxres, rdigit, k.digits[i].rbx.get(), np);
+			}
+		} else if(i == 0) {
+			Ring2Utils::multByKey(axres, bxres, digit, k.digits[i], Pmod, context.N, context.multiplier);
+		} else {
+			Ring2Utils::multByKey(axdigit, bxdigit, digit, k.digits[i], Pmod, context.N, context.multiplier);
+			Ring2Utils::addAndEqual(axres, axdigit, Pmod, context.N);
+			Ring2Utils::addAndEqual(bxres, bxdigit, Pmod, context.N);
+		}
+	}
+	if(np > 0) {
+		multiplier->reconstruct(axres, raxres, np, Pmod);
+		multiplier->reconstruct(bxres, rbxres, np, Pmod);
+	}
+	Ring2Utils::rightShiftAndEqual(axres, k.logP, context.N);
+	Ring2Utils::rightShiftAndEqual(bxres, k.logP, context.N);
+}
+
+void Scheme::modRaiseAndEqual(Ciphertext& cipher, long logq0, long logq, bool sparse) {
+	if(sparse && (keyMap.find(SPARSE_ENCAPSULATION) == keyMap.end() || keyMap.find(SPARSE_DECAPSULATION) == keyMap.end())) {
+		throw invalid_argument("sparse bootstrapping needs keys of addSparseKeys");
+	}
+	modDownToAndEqual(cipher, logq0);
+	if(sparse) {
+		switchKeyAndEqual(cipher, keyMap.at(SPARSE_ENCAPSULATION));
+		Ring2Utils::modAndEqual(cipher.ax, cipher.mod, context.N);
+		Ring2Utils::modAndEqual(cipher.bx, cipher.mod, context.N);
+	}
+	normalizeAndEqual(cipher);
+	cipher.cbits = logq;
+	cipher.mod = power2_ZZ(logq);
+	if(sparse) {
+		Ring2Utils::modAndEqual(cipher.ax, cipher.mod, context.N);
+		Ring2Utils::modAndEqual(cipher.bx, cipher.mod, context.N);
+		switchKeyAndEqual(cipher, keyMap.at(SPARSE_DECAPSULATION));
+	}
+}
+
+Ciphertext Scheme::leftRotateFast(Ciphertext& cipher, long rotSlots) {
+	ScratchArena::Frame frame;
+	ZZX& bxrot = frame.poly();
+	ZZX bxres, axres;
+
+	Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], context.q, context.N);
+	Ring2Utils::inpower(bxres, cipher.ax, context.rotGroup[rotSlots], context.q, context.N);
+
+	switchKey(axres, bxres, bxres, leftRotKeyMap.at(rotSlots), cipher.mod);
 
 	Ring2Utils::addAndEqual(bxres, bxrot, cipher.mod, context.N);
 	return Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
 }
 
 void Scheme::leftRotateAndEqualFast(Ciphertext& cipher, long rotSlots) {
-	ZZ Pmod = cipher.mod << context.logq;
-
-	ZZX bxrot, bxres, axres;
+	ScratchArena::Frame frame;
+	ZZX& bxrot = frame.poly();
+	ZZX& bxres = frame.poly();
+	ZZX& axres = frame.poly();
 
 	Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlots], context.q, context.N);
 	Ring2Utils::inpower(bxres, cipher.ax, context.rotGroup[rotSlots], context.q, context.N);
 
-	Key key = leftRotKeyMap.at(rotSlots);
+	switchKey(axres, bxres, bxres, leftRotKeyMap.at(rotSlots), cipher.mod);
 
-	Ring2Utils::mult(axres, bxres, key.ax, Pmod, context.N);
-	Ring2Utils::multAndEqual(bxres, key.bx, Pmod, context.N);
+	Ring2Utils::addAndEqual(bxres, bxrot, cipher.mod, context.N);
 
-	Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
-	Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+	swap(cipher.ax, axres);
+	swap(cipher.bx, bxres);
+}
+
+Ciphertext* Scheme::leftRotateHoisted(Ciphertext& cipher, long* rotSlotsVec, long size) {
+	Ciphertext* res = new Ciphertext[size];
+	RingMultiplier* multiplier = context.multiplier;
+
+	long bits = 0;
+	bool hybrid = false;
+	vector<shared_ptr<Key> > keys(size);
+	for (long i = 0; i < size; ++i) {
+		if(rotSlotsVec[i] != 0) {
+			Key& key = leftRotKeyMap.at(rotSlotsVec[i]);
+			keys[i] = useLevelKeys ? key.atLevel(context, cipher.cbits) : shared_ptr<Key>();
+			if(!keys[i]) {
+				keys[i] = shared_ptr<Key>(shared_ptr<Key>(), &key);
+			}
+			bits = max(bits, keys[i]->bits);
+			hybrid = hybrid || key.isHybrid();
+		}
+	}
+	long np = multiplier == NULL ? -1 : multiplier->numPrimes(RingMultiplier::maxBits(cipher.ax, context.N) + bits + context.logN);
 
-	Ring2Utils::addAndEqual(bxres, bxrot, cipher.mod, context.N);
+	if(np < 0 || hybrid) {
+		for (long i = 0; i < size; ++i) {
+			res[i] = rotSlotsVec[i] == 0 ? cipher : leftRotateFast(cipher, rotSlotsVec[i]);
+		}
+		return res;
+	}
+
+	ScratchArena::Frame frame;
+	ZZ& Pmod = frame.number();
+	LeftShift(Pmod, cipher.mod, context.logq);
+	long len = np << context.logN;
+	uint64_t* rax = frame.words(len);
+	multiplier->toNTT(rax, cipher.ax, np);
+
+	NTL_EXEC_RANGE(size, first, last);
+	ScratchArena::Frame workerFrame;
+	uint64_t* raxrot = workerFrame.words(len);
+	uint64_t* raxres = workerFrame.words(len);
+	uint64_t* rbxres = workerFrame.words(len);
+	ZZX& bxrot = workerFrame.poly();
+	for (long i = first; i < last; ++i) {
+		if(rotSlotsVec[i] == 0) {
+			res[i] = cipher;
+			continue;
+		}
+		Key& key = *keys[i];
+		if(!key.rax || key.np < np) {
+			res[i] = leftRotateFast(cipher, rotSlotsVec[i]);
+			continue;
+		}
+		ZZX bxres, axres;
+
+		Automorphism& automorphism = context.automorphism(context.rotGroup[rotSlotsVec[i]]);
+		multiplier->automorphism(raxrot, rax, automorphism, np);
+		multiplier->multResidues(raxres, raxrot, key.rax.get(), np);
+		multiplier->multResidues(rbxres, raxrot, key.rbx.get(), np);
+		multiplier->reconstruct(axres, raxres, np, Pmod);
+		multiplier->reconstruct(bxres, rbxres, np, Pmod);
 
-	cipher.ax = axres;
-	cipher.bx = bxres;
+		Ring2Utils::rightShiftAndEqual(axres, context.logq, context.N);
+		Ring2Utils::rightShiftAndEqual(bxres, context.logq, context.N);
+
+		Ring2Utils::inpower(bxrot, cipher.bx, context.rotGroup[rotSlotsVec[i]], context.q, context.N);
+		Ring2Utils::addAndEqual(bxres, bxrot, cipher.mod, context.N);
+		res[i] = Ciphertext(axres, bxres, cipher.mod, cipher.cbits, cipher.slots, cipher.isComplex);
+	}
+	NTL_EXEC_RANGE_END;
+	return res;
 }
 
 Ciphertext Scheme::leftRotateByPo2(Ciphertext& cipher, long logrotSlots) {
@@ -674,29 +1247,32 @@ void Scheme::rightRotateAndEqual(Ciphertext& cipher, long rotSlots) {
 
 Ciphertext Scheme::linearTransform(Ciphertext& cipher, long size) {
 	long logSize = log2(size);
+	if(bootKeyMap.at(logSize).levels > 0) {
+		return linearTransformFactored(cipher, size);
+	}
 	long logSizeh = logSize / 2;
 	long k = 1 << logSizeh;
 	long m = 1 << (logSize - logSizeh);
 
-	Ciphertext* encxrotvec = new Ciphertext[k];
-	encxrotvec[0] = cipher;
-
-	for (long i = 1; i < k; ++i) {
-		encxrotvec[i] = leftRotateFast(encxrotvec[0], i);
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
 	}
+	Ciphertext* encxrotvec = leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
 
-	BootKey bootKey = bootKeyMap.at(logSize);
-	Ciphertext res = multByPoly(encxrotvec[0], bootKey.pvec[0]);
+	BootKey& bootKey = bootKeyMap.at(logSize);
+	Ciphertext res = multByPoly(encxrotvec[0], *bootKey.diagonal(context, 0, false));
 	for (long j = 1; j < k; ++j) {
-		Ciphertext cij = multByPoly(encxrotvec[j], bootKey.pvec[j]);
+		Ciphertext cij = multByPoly(encxrotvec[j], *bootKey.diagonal(context, j, false));
 		addAndEqual(res, cij);
 	}
 
 	for (long i = 1; i < m; ++i) {
 		long ki = k * i;
-		Ciphertext ci0 = multByPoly(encxrotvec[0],bootKey.pvec[ki]);
+		Ciphertext ci0 = multByPoly(encxrotvec[0],*bootKey.diagonal(context, ki, false));
 		for (long j = 1; j < k; ++j) {
-			Ciphertext cij = multByPoly(encxrotvec[j], bootKey.pvec[j + ki]);
+			Ciphertext cij = multByPoly(encxrotvec[j], *bootKey.diagonal(context, j + ki, false));
 			addAndEqual(ci0, cij);
 		}
 		leftRotateAndEqualFast(ci0, ki);
@@ -708,28 +1284,32 @@ Ciphertext Scheme::linearTransform(Ciphertext& cipher, long size) {
 
 Ciphertext Scheme::linearTransformInv(Ciphertext& cipher, long size) {
 	long logSize = log2(size);
+	if(bootKeyMap.at(logSize).levels > 0) {
+		return linearTransformInvFactored(cipher, size);
+	}
 	long logSizeh = logSize / 2;
 	long k = 1 << logSizeh;
 	long m = 1 << (logSize - logSizeh);
 
-	Ciphertext* cipherRotVec = new Ciphertext[k];
-	cipherRotVec[0] = cipher;
-	for (long i = 1; i < k; ++i) {
-		cipherRotVec[i] = leftRotateFast(cipherRotVec[0], i);
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
 	}
-	BootKey bootKey = bootKeyMap.at(logSize);
+	Ciphertext* cipherRotVec = leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
+	BootKey& bootKey = bootKeyMap.at(logSize);
 
-	Ciphertext res = multByPoly(cipherRotVec[0], bootKey.pvecInv[0]);
+	Ciphertext res = multByPoly(cipherRotVec[0], *bootKey.diagonal(context, 0, true));
 
 	for (long j = 1; j < k; ++j) {
-		Ciphertext c0j = multByPoly(cipherRotVec[j], bootKey.pvecInv[j]);
+		Ciphertext c0j = multByPoly(cipherRotVec[j], *bootKey.diagonal(context, j, true));
 		addAndEqual(res, c0j);
 	}
 	for (long i = 1; i < m; ++i) {
 		long ki = k * i;
-		Ciphertext ci0 = multByPoly(cipherRotVec[0], bootKey.pvecInv[ki]);
+		Ciphertext ci0 = multByPoly(cipherRotVec[0], *bootKey.diagonal(context, ki, true));
 		for (long j = 1; j < k; ++j) {
-			Ciphertext cij = multByPoly(cipherRotVec[j], bootKey.pvecInv[j + ki]);
+			Ciphertext cij = multByPoly(cipherRotVec[j], *bootKey.diagonal(context, j + ki, true));
 			addAndEqual(ci0, cij);
 		}
 		leftRotateAndEqualFast(ci0, ki);
@@ -741,30 +1321,34 @@ Ciphertext Scheme::linearTransformInv(Ciphertext& cipher, long size) {
 
 void Scheme::linearTransformAndEqual(Ciphertext& cipher, long size) {
 	long logSize = log2(size);
+	if(bootKeyMap.at(logSize).levels > 0) {
+		linearTransformFactoredAndEqual(cipher, size);
+		return;
+	}
 	long logSizeh = logSize / 2;
 	long k = 1 << logSizeh;
 	long m = 1 << (logSize - logSizeh);
 
-	Ciphertext* encxrotvec = new Ciphertext[k];
-	encxrotvec[0] = cipher;
-
-	for (long i = 1; i < k; ++i) {
-		encxrotvec[i] = leftRotateFast(encxrotvec[0], i);
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
 	}
+	Ciphertext* encxrotvec = leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
 
-	BootKey bootKey = bootKeyMap.at(logSize);
+	BootKey& bootKey = bootKeyMap.at(logSize);
 
-	cipher = multByPoly(encxrotvec[0], bootKey.pvec[0]);
+	cipher = multByPoly(encxrotvec[0], *bootKey.diagonal(context, 0, false));
 	for (long j = 1; j < k; ++j) {
-		Ciphertext cij = multByPoly(encxrotvec[j], bootKey.pvec[j]);
+		Ciphertext cij = multByPoly(encxrotvec[j], *bootKey.diagonal(context, j, false));
 		addAndEqual(cipher, cij);
 	}
 
 	for (long i = 1; i < m; ++i) {
 		long ki = k * i;
-		Ciphertext ci0 = multByPoly(encxrotvec[0], bootKey.pvec[ki]);
+		Ciphertext ci0 = multByPoly(encxrotvec[0], *bootKey.diagonal(context, ki, false));
 		for (long j = 1; j < k; ++j) {
-			Ciphertext cij = multByPoly(encxrotvec[j], bootKey.pvec[j + ki]);
+			Ciphertext cij = multByPoly(encxrotvec[j], *bootKey.diagonal(context, j + ki, false));
 			addAndEqual(ci0, cij);
 		}
 		leftRotateAndEqualFast(ci0, ki);
@@ -775,28 +1359,33 @@ void Scheme::linearTransformAndEqual(Ciphertext& cipher, long size) {
 
 void Scheme::linearTransformInvAndEqual(Ciphertext& cipher, long size) {
 	long logSize = log2(size);
+	if(bootKeyMap.at(logSize).levels > 0) {
+		linearTransformInvFactoredAndEqual(cipher, size);
+		return;
+	}
 	long logSizeh = logSize / 2;
 	long k = 1 << logSizeh;
 	long m = 1 << (logSize - logSizeh);
 
-	Ciphertext* cipherRotVec = new Ciphertext[k];
-	cipherRotVec[0] = cipher;
-	for (long i = 1; i < k; ++i) {
-		cipherRotVec[i] = leftRotateFast(cipherRotVec[0], i);
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
 	}
-	BootKey bootKey = bootKeyMap.at(logSize);
+	Ciphertext* cipherRotVec = leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
+	BootKey& bootKey = bootKeyMap.at(logSize);
 
-	cipher = multByPoly(cipherRotVec[0], bootKey.pvecInv[0]);
+	cipher = multByPoly(cipherRotVec[0], *bootKey.diagonal(context, 0, true));
 
 	for (long j = 1; j < k; ++j) {
-		Ciphertext c0j = multByPoly(cipherRotVec[j], bootKey.pvecInv[j]);
+		Ciphertext c0j = multByPoly(cipherRotVec[j], *bootKey.diagonal(context, j, true));
 		addAndEqual(cipher, c0j);
 	}
 	for (long i = 1; i < m; ++i) {
 		long ki = k * i;
-		Ciphertext ci0 = multByPoly(cipherRotVec[0], bootKey.pvecInv[ki]);
+		Ciphertext ci0 = multByPoly(cipherRotVec[0], *bootKey.diagonal(context, ki, true));
 		for (long j = 1; j < k; ++j) {
-			Ciphertext cij = multByPoly(cipherRotVec[j], bootKey.pvecInv[j + ki]);
+			Ciphertext cij = multByPoly(cipherRotVec[j], *bootKey.diagonal(context, j + ki, true));
 			addAndEqual(ci0, cij);
 		}
 		leftRotateAndEqualFast(ci0, ki);
@@ -805,34 +1394,161 @@ void Scheme::linearTransformInvAndEqual(Ciphertext& cipher, long size) {
 	delete[] cipherRotVec;
 }
 
+Ciphertext Scheme::linearTransformFactored(Ciphertext& cipher, long size) {
+	Ciphertext res = cipher;
+	linearTransformFactoredAndEqual(res, size);
+	return res;
+}
+
+void Scheme::linearTransformFactoredAndEqual(Ciphertext& cipher, long size) {
+	long logSize = log2(size);
+	BootKey& bootKey = bootKeyMap.at(logSize);
+
+	for (long i = 0; i < bootKey.levels; ++i) {
+		if(i > 0) {
+			reScaleByAndEqual(cipher, bootKey.pBits);
+		}
+		Ciphertext* cipherRotVec = leftRotateHoisted(cipher, bootKey.ctsRot[i].data(), bootKey.ctsNum[i]);
+		cipher = multByPoly(cipherRotVec[0], bootKey.ctsPvec[i][0]);
+		for (long j = 1; j < bootKey.ctsNum[i]; ++j) {
+			Ciphertext cj = multByPoly(cipherRotVec[j], bootKey.ctsPvec[i][j]);
+			addAndEqual(cipher, cj);
+		}
+		delete[] cipherRotVec;
+	}
+}
+
+Ciphertext Scheme::linearTransformInvFactored(Ciphertext& cipher, long size) {
+	Ciphertext res = cipher;
+	linearTransformInvFactoredAndEqual(res, size);
+	return res;
+}
+
+void Scheme::linearTransformInvFactoredAndEqual(Ciphertext& cipher, long size) {
+	long logSize = log2(size);
+	BootKey& bootKey = bootKeyMap.at(logSize);
+
+	for (long i = 0; i < bootKey.levels; ++i) {
+		if(i > 0) {
+			reScaleByAndEqual(cipher, bootKey.pBits);
+		}
+		Ciphertext* cipherRotVec = leftRotateHoisted(cipher, bootKey.stcRot[i].data(), bootKey.stcNum[i]);
+		cipher = multByPoly(cipherRotVec[0], bootKey.stcPvec[i][0]);
+		for (long j = 1; j < bootKey.stcNum[i]; ++j) {
+			Ciphertext cj = multByPoly(cipherRotVec[j], bootKey.stcPvec[i][j]);
+			addAndEqual(cipher, cj);
+		}
+		delete[] cipherRotVec;
+	}
+}
+
+void Scheme::linearTransformAndEqual(Ciphertext& cipher, long size, TaskScheduler& scheduler) {
+	long logSize = log2(size);
+	BootKey& bootKey = bootKeyMap.at(logSize);
+	if(bootKey.levels == 0) {
+		linearTransformBSGSAndEqual(cipher, size, false, scheduler);
+		return;
+	}
+	for (long i = 0; i < bootKey.levels; ++i) {
+		if(i > 0) {
+			reScaleByAndEqual(cipher, bootKey.pBits);
+		}
+		linearTransformStageAndEqual(cipher, bootKey.ctsNum[i], bootKey.ctsRot[i].data(), bootKey.ctsPvec[i].data(), scheduler);
+	}
+}
+
+void Scheme::linearTransformInvAndEqual(Ciphertext& cipher, long size, TaskScheduler& scheduler) {
+	long logSize = log2(size);
+	BootKey& bootKey = bootKeyMap.at(logSize);
+	if(bootKey.levels == 0) {
+		linearTransformBSGSAndEqual(cipher, size, true, scheduler);
+		return;
+	}
+	for (long i = 0; i < bootKey.levels; ++i) {
+		if(i > 0) {
+			reScaleByAndEqual(cipher, bootKey.pBits);
+		}
+		linearTransformStageAndEqual(cipher, bootKey.stcNum[i], bootKey.stcRot[i].data(), bootKey.stcPvec[i].data(), scheduler);
+	}
+}
+
+void Scheme::linearTransformBSGSAndEqual(Ciphertext& cipher, long size, bool inv, TaskScheduler& scheduler) {
+	long logSize = log2(size);
+	BootKey* bootKey = &bootKeyMap.at(logSize);
+	long logSizeh = logSize / 2;
+	long k = 1 << logSizeh;
+	long m = 1 << (logSize - logSizeh);
+
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
+	}
+	Ciphertext* cipherRotVec = leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
+
+	Ciphertext* giantVec = new Ciphertext[m];
+	TaskGroup group;
+	for (long i = 0; i < m; ++i) {
+		scheduler.spawn(group, [this, i, k, inv, bootKey, cipherRotVec, giantVec]() {
+			long ki = k * i;
+			giantVec[i] = multByPoly(cipherRotVec[0], *bootKey->diagonal(context, ki, inv));
+			for (long j = 1; j < k; ++j) {
+				Ciphertext cij = multByPoly(cipherRotVec[j], *bootKey->diagonal(context, j + ki, inv));
+				addAndEqual(giantVec[i], cij);
+			}
+			if(i > 0) {
+				leftRotateAndEqualFast(giantVec[i], ki);
+			}
+		});
+	}
+	scheduler.wait(group);
+
+	cipher = giantVec[0];
+	for (long i = 1; i < m; ++i) {
+		addAndEqual(cipher, giantVec[i]);
+	}
+	delete[] giantVec;
+	delete[] cipherRotVec;
+}
+
+void Scheme::linearTransformStageAndEqual(Ciphertext& cipher, long num, long* rot, SparsePoly* pvec, TaskScheduler& scheduler) {
+	Ciphertext* cipherRotVec = leftRotateHoisted(cipher, rot, num);
+	TaskGroup group;
+	for (long j = 0; j < num; ++j) {
+		scheduler.spawn(group, [this, j, pvec, cipherRotVec]() {
+			multByPolyAndEqual(cipherRotVec[j], pvec[j]);
+		});
+	}
+	scheduler.wait(group);
+
+	cipher = cipherRotVec[0];
+	for (long j = 1; j < num; ++j) {
+		addAndEqual(cipher, cipherRotVec[j]);
+	}
+	delete[] cipherRotVec;
+}
+
 Ciphertext Scheme::evaluateSin2pix7(Ciphertext& cipher, long pBits) {
-	Ciphertext cipher2 = square(cipher); //depth 1
-	reScaleByAndEqual(cipher2, pBits);
-	Ciphertext cipher4 = square(cipher2); //depth 2
-	reScaleByAndEqual(cipher4, pBits);
+	Ciphertext cipher2 = squareAndRescale(cipher, pBits); //depth 1
+	Ciphertext cipher4 = squareAndRescale(cipher2, pBits); //depth 2
 	RR c = -4*Pi*Pi*Pi/3;
 	ZZ pc = EvaluatorUtils::evalZZ(c, pBits);
-	Ciphertext tmp = multByConst(cipher, pc);
-	reScaleByAndEqual(tmp, pBits); // depth 1
+	Ciphertext tmp = multByConstAndRescale(cipher, pc, pBits); // depth 1
 
 	c = -3/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
 	Ciphertext cipher13 = addConst(cipher2, pc);
-	multAndEqual(cipher13, tmp);
-	reScaleByAndEqual(cipher13, pBits); // depth 2
+	multAndRescaleAndEqual(cipher13, tmp, pBits); // depth 2
 
 	c = -8*Pi*Pi*Pi*Pi*Pi*Pi*Pi/315;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	tmp = multByConst(cipher, pc);
-	reScaleByAndEqual(tmp, pBits); // depth 1
+	tmp = multByConstAndRescale(cipher, pc, pBits); // depth 1
 
 	c = -21/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
 	Ciphertext cipher57 = addConst(cipher2, pc);
-	multAndEqual(cipher57, tmp);
-	reScaleByAndEqual(cipher57, pBits); // depth 2
-	multAndEqual(cipher57, cipher4);
-	reScaleByAndEqual(cipher57, pBits); // depth 3
+	multAndRescaleAndEqual(cipher57, tmp, pBits); // depth 2
+	multAndRescaleAndEqual(cipher57, cipher4, pBits); // depth 3
 
 	modDownByAndEqual(cipher13, pBits); // depth 3
 	addAndEqual(cipher57, cipher13); // depth 3
@@ -840,44 +1556,35 @@ Ciphertext Scheme::evaluateSin2pix7(Ciphertext& cipher, long pBits) {
 }
 
 void Scheme::evaluateSin2pix7AndEqual(Ciphertext& cipher, long pBits) {
-	Ciphertext cipher2 = square(cipher); //depth 1
-	reScaleByAndEqual(cipher2, pBits);
-	Ciphertext cipher4 = square(cipher2); //depth 2
-	reScaleByAndEqual(cipher4, pBits);
+	Ciphertext cipher2 = squareAndRescale(cipher, pBits); //depth 1
+	Ciphertext cipher4 = squareAndRescale(cipher2, pBits); //depth 2
 	RR c = -4*Pi*Pi*Pi/3;
 	ZZ pc = EvaluatorUtils::evalZZ(c, pBits);
-	Ciphertext tmp = multByConst(cipher, pc);
-	reScaleByAndEqual(tmp, pBits); // depth 1
+	Ciphertext tmp = multByConstAndRescale(cipher, pc, pBits); // depth 1
 
 	c = -3/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
 	Ciphertext cipher13 = addConst(cipher2, pc);
-	multAndEqual(cipher13, tmp);
-	reScaleByAndEqual(cipher13, pBits); // depth 2
+	multAndRescaleAndEqual(cipher13, tmp, pBits); // depth 2
 
 	c = -8*Pi*Pi*Pi*Pi*Pi*Pi*Pi/315;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	tmp = multByConst(cipher, pc);
-	reScaleByAndEqual(tmp, pBits); // depth 1
+	tmp = multByConstAndRescale(cipher, pc, pBits); // depth 1
 
 	c = -21/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
 	cipher = addConst(cipher2, pc);
-	multAndEqual(cipher, tmp);
-	reScaleByAndEqual(cipher, pBits); // depth 2
-	multAndEqual(cipher, cipher4);
-	reScaleByAndEqual(cipher, pBits); // depth 3
+	multAndRescaleAndEqual(cipher, tmp, pBits); // depth 2
+	multAndRescaleAndEqual(cipher, cipher4, pBits); // depth 3
 
 	modDownByAndEqual(cipher13, pBits); // depth 3
 	addAndEqual(cipher, cipher13); // depth 3
 }
 
 Ciphertext Scheme::evaluateCos2pix6(Ciphertext& cipher, long pBits) {
-	Ciphertext cipher2 = square(cipher); //depth 1
-	reScaleByAndEqual(cipher2, pBits);
+	Ciphertext cipher2 = squareAndRescale(cipher, pBits); //depth 1
 
-	Ciphertext cipher4 = square(cipher2); //depth 2
-	reScaleByAndEqual(cipher4, pBits);
+	Ciphertext cipher4 = squareAndRescale(cipher2, pBits); //depth 2
 
 	RR c = -1/(2*Pi*Pi);
 	ZZ pc = EvaluatorUtils::evalZZ(c, pBits);
@@ -885,8 +1592,7 @@ Ciphertext Scheme::evaluateCos2pix6(Ciphertext& cipher, long pBits) {
 
 	c = -2*Pi*Pi;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	multByConstAndEqual(cipher02, pc);
-	reScaleByAndEqual(cipher02, pBits); // depth 2
+	multByConstAndRescaleAndEqual(cipher02, pc, pBits); // depth 2
 
 	c = -15/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
@@ -894,11 +1600,9 @@ Ciphertext Scheme::evaluateCos2pix6(Ciphertext& cipher, long pBits) {
 
 	c = -4*Pi*Pi*Pi*Pi*Pi*Pi/45;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	multByConstAndEqual(cipher46, pc);
-	reScaleByAndEqual(cipher46, pBits); // depth 2
+	multByConstAndRescaleAndEqual(cipher46, pc, pBits); // depth 2
 
-	multAndEqual(cipher46, cipher4);
-	reScaleByAndEqual(cipher46, pBits); // depth 3
+	multAndRescaleAndEqual(cipher46, cipher4, pBits); // depth 3
 
 	modDownByAndEqual(cipher02, pBits); // depth 3
 	addAndEqual(cipher46, cipher02); // depth 3
@@ -906,11 +1610,9 @@ Ciphertext Scheme::evaluateCos2pix6(Ciphertext& cipher, long pBits) {
 }
 
 void Scheme::evaluateCos2pix6AndEqual(Ciphertext& cipher, long pBits) {
-	Ciphertext cipher2 = square(cipher); //depth 1
-	reScaleByAndEqual(cipher2, pBits);
+	Ciphertext cipher2 = squareAndRescale(cipher, pBits); //depth 1
 
-	Ciphertext cipher4 = square(cipher2); //depth 2
-	reScaleByAndEqual(cipher4, pBits);
+	Ciphertext cipher4 = squareAndRescale(cipher2, pBits); //depth 2
 
 	RR c = -1/(2*Pi*Pi);
 	ZZ pc = EvaluatorUtils::evalZZ(c, pBits);
@@ -918,8 +1620,7 @@ void Scheme::evaluateCos2pix6AndEqual(Ciphertext& cipher, long pBits) {
 
 	c = -2*Pi*Pi;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	multByConstAndEqual(cipher02, pc);
-	reScaleByAndEqual(cipher02, pBits); // depth 2
+	multByConstAndRescaleAndEqual(cipher02, pc, pBits); // depth 2
 
 	c = -15/(2*Pi*Pi);
 	pc = EvaluatorUtils::evalZZ(c, pBits);
@@ -927,11 +1628,9 @@ void Scheme::evaluateCos2pix6AndEqual(Ciphertext& cipher, long pBits) {
 
 	c = -4*Pi*Pi*Pi*Pi*Pi*Pi/45;
 	pc = EvaluatorUtils::evalZZ(c, pBits);
-	multByConstAndEqual(cipher, pc);
-	reScaleByAndEqual(cipher, pBits); // depth 2
+	multByConstAndRescaleAndEqual(cipher, pc, pBits); // depth 2
 
-	multAndEqual(cipher, cipher4);
-	reScaleByAndEqual(cipher, pBits); // depth 3
+	multAndRescaleAndEqual(cipher, cipher4, pBits); // depth 3
 
 	modDownByAndEqual(cipher02, pBits); // depth 3
 	addAndEqual(cipher, cipher02); // depth 3
@@ -947,32 +1646,131 @@ Ciphertext Scheme::evaluateSin2x(Ciphertext& cSinx, Ciphertext& cCosx, long prec
 Ciphertext Scheme::evaluateCos2x(Ciphertext& cSinx, Ciphertext& cCosx, long precisionBits) {
 	Ciphertext cSub = sub(cCosx, cSinx);
 	Ciphertext cAdd = add(cCosx, cSinx);
-	multAndEqual(cAdd, cSub);
-	reScaleByAndEqual(cAdd, precisionBits);
+	multAndRescaleAndEqual(cAdd, cSub, precisionBits);
 	return cAdd;
 }
 
 Ciphertext Scheme::removeIpart(Ciphertext& cipher, long logq0, long logT, long logI) {
-	Ciphertext cms = reScaleBy(cipher, logT);
+	Ciphertext res = cipher;
+	removeIpartAndEqual(res, logq0, logT, logI);
+	return res;
+}
 
-	Ciphertext cipherSinx = evaluateSin2pix7(cms, logq0 + logI);
-	Ciphertext cipherCosx = evaluateCos2pix6(cms, logq0 + logI);
+Ciphertext Scheme::evaluateChebyshev(Ciphertext& cipher, vector<RR>& coeffs, long degree, long pBits) {
+	long baby = 1L << EvalModPlan::logBabyStep(degree);
+	long size = min(baby, degree);
+	vector<Ciphertext> basis(size + 1);
+	basis[1] = cipher;
+	ZZ negOne = -power2_ZZ(pBits);
+	for (long i = 2; i <= size; ++i) {
+		long a = 1;
+		while (2 * a < i) {
+			a <<= 1;
+		}
+		long b = i - a;
+		Ciphertext cb = modDownTo(basis[b], basis[a].cbits);
+		basis[i] = mult(basis[a], cb);
+		reScaleByAndEqual(basis[i], pBits - 1);
+		if(a == b) {
+			addConstAndEqual(basis[i], negOne);
+		} else {
+			Ciphertext cab = modDownTo(basis[a - b], basis[i].cbits);
+			subAndEqual(basis[i], cab);
+		}
+	}
 
-	Ciphertext cipherSin2x, cipherCos2x;
-	for (long i = 0; i < logI + logT - 1; ++i) {
-		cipherSin2x = evaluateSin2x(cipherSinx, cipherCosx, logq0 + logI);
-		cipherCos2x = evaluateCos2x(cipherSinx, cipherCosx, logq0 + logI);
-		cipherSinx = cipherSin2x;
-		cipherCosx = cipherCos2x;
+	vector<Ciphertext> giants;
+	if(degree >= baby) {
+		giants.push_back(basis[baby]);
+		basis.pop_back();
+		for (long n = baby; 2 * n <= degree; n <<= 1) {
+			Ciphertext giant = square(giants.back());
+			reScaleByAndEqual(giant, pBits - 1);
+			addConstAndEqual(giant, negOne);
+			giants.push_back(giant);
+		}
 	}
-	cipherSinx = evaluateSin2x(cipherSinx, cipherCosx, logq0 + logI);
-	ZZ temp = EvaluatorUtils::evalZZ(1/(2*Pi), logq0 + logI);
-	multByConstAndEqual(cipherSinx, temp);
-	reScaleByAndEqual(cipherSinx, logq0 + 2 * logI);
-	return cipherSinx;
+	vector<RR> series(coeffs.begin(), coeffs.begin() + degree + 1);
+	return evaluateChebyshevSplit(basis, giants, series, pBits);
+}
+
+Ciphertext Scheme::evaluateChebyshevSplit(vector<Ciphertext>& basis, vector<Ciphertext>& giants, vector<RR>& coeffs, long pBits) {
+	long degree = coeffs.size() - 1;
+	long baby = basis.size();
+	if(degree < baby) {
+		long minbits = basis[1].cbits;
+		for (long i = 2; i <= degree; ++i) {
+			minbits = min(minbits, basis[i].cbits);
+		}
+		Ciphertext res = modDownTo(basis[1], minbits);
+		ZZ c1 = EvaluatorUtils::evalZZ(coeffs[1], pBits);
+		multByConstAndEqual(res, c1);
+		for (long i = 2; i <= degree; ++i) {
+			ZZ ci = EvaluatorUtils::evalZZ(coeffs[i], pBits);
+			if(IsZero(ci)) continue;
+			Ciphertext term = multByConst(basis[i], ci);
+			modDownToAndEqual(term, minbits);
+			addAndEqual(res, term);
+		}
+		ZZ c0 = EvaluatorUtils::evalZZ(coeffs[0], 2 * pBits);
+		addConstAndEqual(res, c0);
+		reScaleByAndEqual(res, pBits);
+		return res;
+	}
+	long j = 0;
+	long n = baby;
+	while (2 * n <= degree) {
+		n <<= 1;
+		j++;
+	}
+	// T_i = 2 T_n T_(i - n) - T_(2n - i) splits series into quotient of T_n and remainder of degree below n
+	vector<RR> quotient(degree - n + 1);
+	vector<RR> remainder(coeffs.begin(), coeffs.begin() + n);
+	quotient[0] = coeffs[n];
+	for (long i = n + 1; i <= degree; ++i) {
+		quotient[i - n] = 2 * coeffs[i];
+		remainder[2 * n - i] -= coeffs[i];
+	}
+	Ciphertext res;
+	if(degree == n) {
+		ZZ cn = EvaluatorUtils::evalZZ(quotient[0], pBits);
+		res = multByConst(giants[j], cn);
+	} else {
+		res = evaluateChebyshevSplit(basis, giants, quotient, pBits);
+		Ciphertext giant = giants[j];
+		long minbits = min(res.cbits, giant.cbits);
+		modDownToAndEqual(res, minbits);
+		modDownToAndEqual(giant, minbits);
+		multAndEqual(res, giant);
+	}
+	reScaleByAndEqual(res, pBits);
+	Ciphertext cr = evaluateChebyshevSplit(basis, giants, remainder, pBits);
+	long minbits = min(res.cbits, cr.cbits);
+	modDownToAndEqual(res, minbits);
+	modDownToAndEqual(cr, minbits);
+	addAndEqual(res, cr);
+	return res;
 }
 
 void Scheme::removeIpartAndEqual(Ciphertext& cipher, long logq0, long logT, long logI) {
+	if(evalModPlanMap.find(logI) != evalModPlanMap.end()) {
+		EvalModPlan& plan = evalModPlanMap.at(logI);
+		if(plan.logT != logT) {
+			throw invalid_argument("EvalModPlan is made for another logT");
+		}
+		long pBits = logq0 + logI;
+		cipher = evaluateChebyshev(cipher, plan.coeffs, plan.degree, pBits);
+		ZZ negOne = -power2_ZZ(pBits);
+		for (long i = 0; i < plan.doubleAngles; ++i) {
+			squareAndEqual(cipher);
+			reScaleByAndEqual(cipher, pBits - 1);
+			addConstAndEqual(cipher, negOne);
+		}
+		ZZ temp = EvaluatorUtils::evalZZ(1/(2*Pi), pBits);
+		multByConstAndEqual(cipher, temp);
+		reScaleByAndEqual(cipher, logq0 + 2 * logI);
+		return;
+	}
 	Ciphertext cms = reScaleBy(cipher, logT);
 
 	Ciphertext cipherSinx = evaluateSin2pix7(cms, logq0 + logI);
@@ -992,18 +1790,15 @@ void Scheme::removeIpartAndEqual(Ciphertext& cipher, long logq0, long logT, long
 	reScaleByAndEqual(cipher, logq0 + 2 * logI);
 }
 
-Ciphertext Scheme::bootstrap(Ciphertext& cipher, long logq0, long logq, long logT, long logI) {
+Ciphertext Scheme::bootstrap(Ciphertext& cipher, long logq0, long logq, long logT, long logI, bool sparse) {
 	Ciphertext tmp = cipher;
-	bootstrapAndEqual(tmp, logq0, logq, logT, logI);
+	bootstrapAndEqual(tmp, logq0, logq, logT, logI, sparse);
 	return tmp;
 }
 
-void Scheme::bootstrapAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI) {
+void Scheme::bootstrapAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI, bool sparse) {
 	long logSlots = log2(cipher.slots);
-	modDownToAndEqual(cipher, logq0);
-	normalizeAndEqual(cipher);
-	cipher.cbits = logq;
-	cipher.mod = power2_ZZ(logq);
+	modRaiseAndEqual(cipher, logq0, logq, sparse);
 
 	if(logSlots == context.logN - 1) {
 		Ciphertext cshift1 = multByMonomial(cipher, 2 * context.N - 1);
@@ -1045,18 +1840,65 @@ void Scheme::bootstrapAndEqual(Ciphertext& cipher, long logq0, long logq, long l
 	}
 }
 
-Ciphertext Scheme::bootstrapOneReal(Ciphertext& cipher, long logq0, long logq, long logT, long logI) {
+Ciphertext Scheme::bootstrapParallel(Ciphertext& cipher, TaskScheduler& scheduler, long logq0, long logq, long logT, long logI, bool sparse) {
 	Ciphertext boot = cipher;
-	bootstrapOneRealAndEqual(boot, logq0, logq, logT, logI);
+	bootstrapParallelAndEqual(boot, scheduler, logq0, logq, logT, logI, sparse);
 	return boot;
 }
 
-void Scheme::bootstrapOneRealAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI) {
+void Scheme::bootstrapParallelAndEqual(Ciphertext& cipher, TaskScheduler& scheduler, long logq0, long logq, long logT, long logI, bool sparse) {
 	long logSlots = log2(cipher.slots);
-	modDownToAndEqual(cipher, logq0);
-	normalizeAndEqual(cipher);
-	cipher.cbits = logq;
-	cipher.mod = power2_ZZ(logq);
+	modRaiseAndEqual(cipher, logq0, logq, sparse);
+
+	if(logSlots == context.logN - 1) {
+		Ciphertext cshift1 = multByMonomial(cipher, 2 * context.N - 1);
+		Ciphertext* halves[2] = {&cipher, &cshift1};
+		long size = context.N / 2;
+
+		TaskGroup group;
+		for (long h = 0; h < 2; ++h) {
+			Ciphertext* half = halves[h];
+			scheduler.spawn(group, [this, half, size, &scheduler, logq0, logT, logI, logSlots]() {
+				linearTransformAndEqual(*half, size, scheduler);
+				Ciphertext clinConj = conjugate(*half);
+				addAndEqual(*half, clinConj);
+				reScaleByAndEqual(*half, logq0 + logI + logSlots);
+				removeIpartAndEqual(*half, logq0, logT, logI);
+				linearTransformInvAndEqual(*half, size, scheduler);
+			});
+		}
+		scheduler.wait(group);
+
+		multByMonomialAndEqual(cshift1, 1);
+		addAndEqual(cipher, cshift1);
+		reScaleByAndEqual(cipher, logq0 + logI);
+	} else {
+		for (long i = logSlots; i < context.logN - 1; ++i) {
+			Ciphertext rot = leftRotateByPo2(cipher, i);
+			addAndEqual(cipher, rot);
+		}
+		reScaleByAndEqual(cipher, context.logN - 1 - logSlots);
+		linearTransformAndEqual(cipher, cipher.slots * 2, scheduler);
+
+		Ciphertext cconj = conjugate(cipher);
+		addAndEqual(cipher, cconj);
+		reScaleByAndEqual(cipher, logq0 + logI + logSlots + 2);
+
+		removeIpartAndEqual(cipher, logq0, logT, logI);
+		linearTransformInvAndEqual(cipher, cipher.slots * 2, scheduler);
+		reScaleByAndEqual(cipher, logq0 + logI);
+	}
+}
+
+Ciphertext Scheme::bootstrapOneReal(Ciphertext& cipher, long logq0, long logq, long logT, long logI, bool sparse) {
+	Ciphertext boot = cipher;
+	bootstrapOneRealAndEqual(boot, logq0, logq, logT, logI, sparse);
+	return boot;
+}
+
+void Scheme::bootstrapOneRealAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI, bool sparse) {
+	long logSlots = log2(cipher.slots);
+	modRaiseAndEqual(cipher, logq0, logq, sparse);
 
 	for (long i = logSlots; i < context.logN - 1; ++i) {
 		Ciphertext rot = leftRotateByPo2(cipher, i);
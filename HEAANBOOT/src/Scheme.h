@@ -4,37 +4,106 @@
 #include <NTL/RR.h>
 #include <NTL/ZZ.h>
 #include <NTL/ZZX.h>
+#include <NTL/BasicThreadPool.h>
 
+#include <cfloat>
 
 #include "Common.h"
 #include "CZZ.h"
 #include "SecretKey.h"
 #include "Ciphertext.h"
+#include "Ciphertext3.h"
+#include "PackedCiphertext.h"
 #include "Plaintext.h"
 #include "Key.h"
 #include "Context.h"
 #include "BootKey.h"
+#include "EvalModPlan.h"
 #include "EvaluatorUtils.h"
 #include "NumUtils.h"
 #include "Params.h"
 #include "Ring2Utils.h"
+#include "ScratchArena.h"
+#include "TaskScheduler.h"
 
 using namespace std;
 using namespace NTL;
 
-static long ENCRYPTION = 0;
-static long MULTIPLICATION  = 1;
-static long CONJUGATION = 2;
+static const long ENCRYPTION = 0;
+static const long MULTIPLICATION  = 1;
+static const long CONJUGATION = 2;
+static const long SPARSE_ENCAPSULATION = 3; ///< key switching from secret key to sparse secret key
+static const long SPARSE_DECAPSULATION = 4; ///< key switching from sparse secret key back to secret key
+
+static const long FFT_DOUBLE_BITS = DBL_MANT_DIG - 3; ///< encoding and decoding up to this precision use double fft
+static const long FFT_LONG_DOUBLE_BITS = LDBL_MANT_DIG - 3; ///< encoding and decoding up to this precision use long double fft, RR is used otherwise
+
+static const long RESCALE_TRUNCATE = 0; ///< rescaling drops low bits of coefficients
+static const long RESCALE_ROUND = 1; ///< rescaling rounds coefficients to nearest, error of rescaling is dominated by a * s in both modes
 
 class Scheme {
 private:
+
+	/**
+	 * products (a1 + b1) * (a2 + b2), b1 * b2 and a1 * a2 of ciphers on NTL thread pool
+	 */
+	void multProducts(ZZX& axbx, ZZX& bxbx, ZZX& axax, Ciphertext& cipher1, Ciphertext& cipher2);
+
+	/**
+	 * products 2 * a * b, b * b and a * a of cipher on NTL thread pool
+	 */
+	void squareProducts(ZZX& axbx, ZZX& bxbx, ZZX& axax, Ciphertext& cipher);
+
+	/**
+	 * evaluation of Chebyshev series split by the largest giant step T_n not above its degree:
+	 * sum c_i T_i = q * T_n + r with deg q, deg r < n, series below baby steps is a sum of baby steps with constants
+	 * @param[in] basis baby steps T_0, ..., T_(baby - 1) with empty T_0
+	 * @param[in] giants giant steps T_baby, T_(2 baby), ...
+	 * @param[in] coeffs coefficients of series
+	 * @return cipher of series with scale 2^pBits
+	 */
+	Ciphertext evaluateChebyshevSplit(vector<Ciphertext>& basis, vector<Ciphertext>& giants, vector<RR>& coeffs, long pBits);
+
+	/**
+	 * final pass of multiplication: products are added to linearized (axres, bxres) and rescaled in one loop
+	 * @param[in, out] axres, bxres key switching of axax -> rescaled cipher of product
+	 * @param[in] isSquare true if axbx is already 2 * a * b, otherwise bxbx and axax are subtracted from it
+	 */
+	void combineAndRescale(ZZX& axres, ZZX& bxres, ZZX& axbx, ZZX& bxbx, ZZX& axax, bool isSquare, ZZ& mod, long bitsDown);
+
+	/**
+	 * division of one coefficient by 2^bitsDown in rescaleMode, half is 2^(bitsDown - 1)
+	 */
+	void reScaleCoeff(ZZ& x, long bitsDown, ZZ& half);
 public:
 	Context& context;
 	map<long, Key> keyMap;
 	map<long, Key> leftRotKeyMap;
 	map<long, BootKey> bootKeyMap;
+	DiagonalCache diagonalCache; ///< diagonals of lazy BootKeys of all sizes
+	map<long, EvalModPlan> evalModPlanMap; ///< Chebyshev approximations used in removeIpart instead of Taylor ones, by logI
+
+	long rescaleMode; ///< RESCALE_TRUNCATE or RESCALE_ROUND, used in all rescaling procedures
+	long dnum; ///< number of digits of hybrid switching keys generated by add*Key functions, 0 for keys modulo qq
+	bool useLevelKeys; ///< key switching uses keys reduced to the modulus of ciphertext, see Key::atLevel
+
+	/**
+	 * @param[in] secretKey secret key
+	 * @param[in] context context
+	 * @param[in] dnum if positive, switching keys are hybrid with dnum digits and special modulus of ceil(logq / dnum) bits,
+	 * this is not a speedup: keys are modulo 2^(logq + logP) instead of qq, which allows larger logq for the same
+	 * key modulus, but keys and key switching are about (dnum + 1) / 2 times larger and slower
+	 */
+	Scheme(SecretKey& secretKey, Context& context, long dnum = 0);
 
-	Scheme(SecretKey& secretKey, Context& context);
+	/**
+	 * generates key switching from sxFrom to sxTo: bx + ax * sxTo = e + P * sxFrom,
+	 * with P = q modulo qq, or hybrid key if dnum is positive
+	 * @param[in] sxFrom secret of switched ciphertexts
+	 * @param[in] sxTo secret of resulting ciphertexts
+	 * @return switching key
+	 */
+	Key generateSwitchKey(ZZX& sxFrom, ZZX& sxTo);
 
 	void addEncKey(SecretKey& secretKey);
 	void addConjKey(SecretKey& secretKey);
@@ -44,7 +113,56 @@ public:
 	void addLeftRotKeys(SecretKey& secretKey);
 	void addRightRotKeys(SecretKey& secretKey);
 
-	void addBootKeys(SecretKey& secretKey, long logsize, long pBits);
+	/**
+	 * generates BootKey for matrices of size 2^logsize and rotation keys needed to evaluate it
+	 * @param[in] levels 0 for dense linear transforms, otherwise number of stages of factored linear transforms
+	 * @param[in] sparseh if positive, also generates keys of sparse secret encapsulation with this hamming weight
+	 */
+	void addBootKeys(SecretKey& secretKey, long logsize, long pBits, long levels = 0, long sparseh = 0);
+
+	/**
+	 * generates temporary secret key with sparseh nonzero coefficients and key switching keys to it and back,
+	 * bootstrapping with sparse set then raises modulus under the sparse secret, so I is smaller and logI is sparseLogI(sparseh)
+	 * @param[in] secretKey secret key
+	 * @param[in] sparseh hamming weight of temporary secret key
+	 */
+	void addSparseKeys(SecretKey& secretKey, long sparseh);
+
+	/**
+	 * I of modulus raising under secret with sparseh nonzero coefficients is a sum of sparseh roundings,
+	 * so 2^logI = 2 sqrt(sparseh) bounds it by about 7 standard deviations
+	 * @param[in] sparseh hamming weight of secret of modulus raising
+	 * @return logI of bootstrapping and of BootKey precision logq0 + logI
+	 */
+	static long sparseLogI(long sparseh);
+
+	/**
+	 * generates lazy BootKey for dense matrices of size 2^logsize and rotation keys needed to evaluate it,
+	 * diagonals are encoded on demand and kept in diagonalCache
+	 * @param[in] secretKey secret key
+	 * @param[in] logsize log of matrix size
+	 * @param[in] pBits precision bits of encoded diagonals
+	 */
+	void addLazyBootKeys(SecretKey& secretKey, long logsize, long pBits);
+
+	/**
+	 * drops ax of all seeded keys in keyMap and leftRotKeyMap, which halves their size for storage or transfer
+	 */
+	void compressKeys();
+
+	/**
+	 * restores ax of all compressed keys from their seeds, needed before keys are used
+	 */
+	void expandKeys();
+
+	/**
+	 * plans Chebyshev approximation of modular reduction used by removeIpart for this logI and logT
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] logT logT of removeIpart, the plan uses at most logI + logT double-angle steps
+	 * @param[in] precisionBits required bits of precision of sin(2pi * 2^logI * u)
+	 * @param[in] maxDegree largest degree of Chebyshev approximation
+	 */
+	void addEvalModPlan(long logI, long logT, long precisionBits, long maxDegree = 127);
 	void addSortKeys(SecretKey& secretKey, long size);
 
 	//-----------------------------------------
@@ -208,7 +326,8 @@ public:
 
 	/**
 	 * multiplication of ciphers. This algorithm contain linearization.
-	 * To manage the noise we usually need modular switching method after mult
+	 * To manage the noise we usually need modular switching method after mult.
+	 * Three independent products run on NTL thread pool
 	 * @param[in] cipher(m1)
 	 * @param[in] cipher(m2)
 	 * @return cipher(m1 * m2)
@@ -242,6 +361,113 @@ public:
 
 	//-----------------------------------------
 
+	/**
+	 * multiplication of ciphers without linearization.
+	 * Products can be summed as ciphers of degree 2 and linearized once with relinearize
+	 * @param[in] cipher(m1)
+	 * @param[in] cipher(m2)
+	 * @return cipher of degree 2 (m1 * m2)
+	 */
+	Ciphertext3 multNoRelin(Ciphertext& cipher1, Ciphertext& cipher2);
+
+	/**
+	 * square of cipher without linearization
+	 * @param[in] cipher(m)
+	 * @return cipher of degree 2 (m^2)
+	 */
+	Ciphertext3 squareNoRelin(Ciphertext& cipher);
+
+	/**
+	 * addition of ciphers of degree 2
+	 * @param[in] cipher(m1)
+	 * @param[in] cipher(m2)
+	 * @return cipher(m1 + m2)
+	 */
+	Ciphertext3 add(Ciphertext3& cipher1, Ciphertext3& cipher2);
+
+	/**
+	 * addition of ciphers of degree 2
+	 * @param[in, out] cipher(m1) -> cipher(m1 + m2)
+	 * @param[in] cipher(m2)
+	 */
+	void addAndEqual(Ciphertext3& cipher1, Ciphertext3& cipher2);
+
+	/**
+	 * addition of cipher to cipher of degree 2
+	 * @param[in, out] cipher(m1) -> cipher(m1 + m2)
+	 * @param[in] cipher(m2)
+	 */
+	void addAndEqual(Ciphertext3& cipher1, Ciphertext& cipher2);
+
+	/**
+	 * subtraction of ciphers of degree 2
+	 * @param[in] cipher(m1)
+	 * @param[in] cipher(m2)
+	 * @return cipher(m1 - m2)
+	 */
+	Ciphertext3 sub(Ciphertext3& cipher1, Ciphertext3& cipher2);
+
+	/**
+	 * subtraction of ciphers of degree 2
+	 * @param[in, out] cipher(m1) -> cipher(m1 - m2)
+	 * @param[in] cipher(m2)
+	 */
+	void subAndEqual(Ciphertext3& cipher1, Ciphertext3& cipher2);
+
+	/**
+	 * linearization of cipher of degree 2 with MULTIPLICATION key
+	 * @param[in] cipher of degree 2 (m)
+	 * @return cipher(m)
+	 */
+	Ciphertext relinearize(Ciphertext3& cipher);
+
+	//-----------------------------------------
+
+	/**
+	 * multiplication of ciphers followed by rescaling, products are combined and rescaled
+	 * in one pass over coefficients, result is the same as of mult and reScaleByAndEqual
+	 * @param[in] cipher(m1)
+	 * @param[in] cipher(m2)
+	 * @param[in] bitsDown
+	 * @return cipher(m1 * m2 / 2^bitsDown) with new cbits
+	 */
+	Ciphertext multAndRescale(Ciphertext& cipher1, Ciphertext& cipher2, long bitsDown);
+
+	/**
+	 * multiplication of ciphers followed by rescaling in one pass over coefficients
+	 * @param[in, out] cipher(m1) -> cipher(m1 * m2 / 2^bitsDown) with new cbits
+	 * @param[in] cipher(m2)
+	 * @param[in] bitsDown
+	 */
+	void multAndRescaleAndEqual(Ciphertext& cipher1, Ciphertext& cipher2, long bitsDown);
+
+	/**
+	 * square of cipher followed by rescaling in one pass over coefficients
+	 * @param[in] cipher(m)
+	 * @param[in] bitsDown
+	 * @return cipher(m^2 / 2^bitsDown) with new cbits
+	 */
+	Ciphertext squareAndRescale(Ciphertext& cipher, long bitsDown);
+
+	/**
+	 * square of cipher followed by rescaling in one pass over coefficients
+	 * @param[in, out] cipher(m) -> cipher(m^2 / 2^bitsDown) with new cbits
+	 * @param[in] bitsDown
+	 */
+	void squareAndRescaleAndEqual(Ciphertext& cipher, long bitsDown);
+
+	/**
+	 * multiplication of ciphers added to accumulator, linearized product is added
+	 * in the same pass over coefficients without temporary cipher,
+	 * throws invalid_argument if acc has other cbits, mod or slots than cipher1
+	 * @param[in, out] acc(m) -> acc(m + m1 * m2)
+	 * @param[in] cipher(m1) with the same cbits as acc
+	 * @param[in] cipher(m2)
+	 */
+	void multAcc(Ciphertext& acc, Ciphertext& cipher1, Ciphertext& cipher2);
+
+	//-----------------------------------------
+
 	/**
 	 * constant multiplication
 	 * @param[in] cipher(m)
@@ -257,6 +483,23 @@ public:
 	 */
 	void multByConstAndEqual(Ciphertext& cipher, ZZ& cnst);
 
+	/**
+	 * constant multiplication followed by rescaling in one pass over coefficients
+	 * @param[in] cipher(m)
+	 * @param[in] constant
+	 * @param[in] bitsDown
+	 * @return cipher(m * constant / 2^bitsDown) with new cbits
+	 */
+	Ciphertext multByConstAndRescale(Ciphertext& cipher, ZZ& cnst, long bitsDown);
+
+	/**
+	 * constant multiplication followed by rescaling in one pass over coefficients
+	 * @param[in, out] cipher(m) -> cipher(m * constant / 2^bitsDown) with new cbits
+	 * @param[in] constant
+	 * @param[in] bitsDown
+	 */
+	void multByConstAndRescaleAndEqual(Ciphertext& cipher, ZZ& cnst, long bitsDown);
+
 	/**
 	 * polynomial multiplication
 	 * @param[in] cipher(m)
@@ -272,6 +515,21 @@ public:
 	 */
 	void multByPolyAndEqual(Ciphertext& cipher, ZZX& poly);
 
+	/**
+	 * multiplication by sparse polynomial
+	 * @param[in] cipher(m)
+	 * @param[in] poly sparse polynomial
+	 * @return cipher(m * poly)
+	 */
+	Ciphertext multByPoly(Ciphertext& cipher, SparsePoly& poly);
+
+	/**
+	 * multiplication by sparse polynomial
+	 * @param[in, out] cipher(m) -> cipher(m * poly)
+	 * @param[in] poly sparse polynomial
+	 */
+	void multByPolyAndEqual(Ciphertext& cipher, SparsePoly& poly);
+
 	/**
 	 * X^degree multiplication
 	 * @param[in] cipher(m)
@@ -342,6 +600,68 @@ public:
 	void modDownByAndEqual(Ciphertext& cipher, long bitsDown);
 
 	void modDownToAndEqual(Ciphertext& cipher, long cbits);
+
+	/**
+	 * key switching
+	 * @param[in, out] cipher under secret s1 -> cipher under secret s2
+	 * @param[in] key switching key from s1 to s2
+	 */
+	void switchKeyAndEqual(Ciphertext& cipher, Key& key);
+
+	/**
+	 * product of p by switching key divided by special modulus,
+	 * hybrid key splits p into digits and skips digits above mod,
+	 * key reduced to mod is used instead of key if useLevelKeys is set
+	 * @param[out] axres, bxres pair with bxres + axres * s2 = p * s1 + e modulo mod
+	 * @param[in] p polynomial modulo mod, may be the same as bxres
+	 * @param[in] key switching key from s1 to s2
+	 * @param[in] mod modulus of ciphertext
+	 */
+	void switchKey(ZZX& axres, ZZX& bxres, ZZX& p, Key& key, ZZ& mod);
+
+	/**
+	 * modulus raising of bootstrapping: cipher is reduced modulo 2^logq0 and considered modulo 2^logq
+	 * @param[in, out] cipher(m) -> cipher(m + 2^logq0 * I) modulo 2^logq
+	 * @param[in] sparse if set, modulus is raised under sparse secret of SPARSE_ENCAPSULATION and SPARSE_DECAPSULATION keys
+	 * @throws invalid_argument if sparse is set and keyMap has no such keys
+	 */
+	void modRaiseAndEqual(Ciphertext& cipher, long logq0, long logq, bool sparse);
+
+	//-----------------------------------------
+
+	/**
+	 * @param[in] cipher
+	 * @return the same cipher with coefficients stored as 64-bit words
+	 */
+	PackedCiphertext pack(Ciphertext& cipher);
+
+	/**
+	 * @param[in] cipher with coefficients stored as 64-bit words
+	 * @return the same cipher with ZZX coefficients
+	 */
+	Ciphertext unpack(PackedCiphertext& cipher);
+
+	/**
+	 * addition of packed ciphers with the same cbits
+	 * @param[in, out] cipher1(m1) -> cipher(m1 + m2)
+	 * @param[in] cipher2(m2)
+	 */
+	void addAndEqual(PackedCiphertext& cipher1, PackedCiphertext& cipher2);
+
+	/**
+	 * subtraction of packed ciphers with the same cbits
+	 * @param[in, out] cipher1(m1) -> cipher(m1 - m2)
+	 * @param[in] cipher2(m2)
+	 */
+	void subAndEqual(PackedCiphertext& cipher1, PackedCiphertext& cipher2);
+
+	/**
+	 * rescaling procedure of packed cipher
+	 * @param[in, out] cipher(m) -> cipher(m/2^bitsDown) with new cbits
+	 * @param[in] bitsDown
+	 */
+	void reScaleByAndEqual(PackedCiphertext& cipher, long bitsDown);
+
 	/**
 	 * calculates cipher of array with rotated indexes
 	 * @param[in] cipher(m(v_1, v_2, ..., v_slots))
@@ -378,6 +698,17 @@ public:
 
 	void leftRotateAndEqualFast(Ciphertext& cipher, long rotSlots);
 
+	/**
+	 * calculates several rotations of the same cipher, cipher.ax is transformed once and
+	 * all automorphisms and key products are applied to its residues, rotations run on NTL thread pool,
+	 * rotations by hybrid keys fall back to leftRotateFast
+	 * @param[in] cipher(m(v_1, v_2, ..., v_slots))
+	 * @param[in] rotSlotsVec array of rotation slots, 0 gives a copy of cipher
+	 * @param[in] size size of rotSlotsVec
+	 * @return array of ciphers (m(v_{1+rotSlotsVec[i]}, ..., v_{slots+rotSlotsVec[i]}))
+	 */
+	Ciphertext* leftRotateHoisted(Ciphertext& cipher, long* rotSlotsVec, long size);
+
 	/**
 	 * calculates cipher of array with rotated indexes
 	 * @param[in] cipher(m(v_1, v_2, ..., v_slots))
@@ -418,6 +749,66 @@ public:
 
 	void linearTransformInvAndEqual(Ciphertext& cipher, long size);
 
+	/**
+	 * CoeffToSlot as a product of sparse FFT stages from BootKey with levels > 0,
+	 * cipher is rescaled by pBits between stages, output slots are in bit-reversed order
+	 * inside halves and are expected by linearTransformInvFactored
+	 * @param[in] cipher
+	 * @param[in] size size of matrix
+	 * @return cipher after CoeffToSlot, scaled by 2^pBits as in linearTransform
+	 */
+	Ciphertext linearTransformFactored(Ciphertext& cipher, long size);
+
+	void linearTransformFactoredAndEqual(Ciphertext& cipher, long size);
+
+	/**
+	 * SlotToCoeff as a product of sparse FFT stages from BootKey with levels > 0,
+	 * cipher is rescaled by pBits between stages
+	 * @param[in] cipher output of linearTransformFactored after slot-wise operations
+	 * @param[in] size size of matrix
+	 * @return cipher after SlotToCoeff, scaled by 2^pBits as in linearTransformInv
+	 */
+	Ciphertext linearTransformInvFactored(Ciphertext& cipher, long size);
+
+	void linearTransformInvFactoredAndEqual(Ciphertext& cipher, long size);
+
+	/**
+	 * CoeffToSlot with products of diagonals as tasks of scheduler:
+	 * giant steps of dense matrix or diagonals of each factored stage run concurrently
+	 * @param[in, out] cipher -> cipher after CoeffToSlot as in linearTransform
+	 * @param[in] size size of matrix
+	 * @param[in] scheduler task scheduler
+	 */
+	void linearTransformAndEqual(Ciphertext& cipher, long size, TaskScheduler& scheduler);
+
+	/**
+	 * SlotToCoeff with products of diagonals as tasks of scheduler
+	 * @param[in, out] cipher -> cipher after SlotToCoeff as in linearTransformInv
+	 * @param[in] size size of matrix
+	 * @param[in] scheduler task scheduler
+	 */
+	void linearTransformInvAndEqual(Ciphertext& cipher, long size, TaskScheduler& scheduler);
+
+	/**
+	 * sum over giant steps i of rotations by k * i of sum over baby steps j of diag_{k * i + j} * rot_j(cipher),
+	 * every giant step is a task of scheduler
+	 * @param[in, out] cipher -> transformed cipher
+	 * @param[in] size size of matrix
+	 * @param[in] inv false for diagonals of CoeffToSlot, true for SlotToCoeff
+	 * @param[in] scheduler task scheduler
+	 */
+	void linearTransformBSGSAndEqual(Ciphertext& cipher, long size, bool inv, TaskScheduler& scheduler);
+
+	/**
+	 * sum of pvec[j] * rot_{rot[j]}(cipher), every product is a task of scheduler
+	 * @param[in, out] cipher -> transformed cipher
+	 * @param[in] num number of diagonals
+	 * @param[in] rot left rotations of diagonals
+	 * @param[in] pvec encoded diagonals
+	 * @param[in] scheduler task scheduler
+	 */
+	void linearTransformStageAndEqual(Ciphertext& cipher, long num, long* rot, SparsePoly* pvec, TaskScheduler& scheduler);
+
 	Ciphertext evaluateSin2pix7(Ciphertext& cipher, long pBits);
 
 	void evaluateSin2pix7AndEqual(Ciphertext& cipher, long pBits);
@@ -430,17 +821,52 @@ public:
 
 	Ciphertext evaluateCos2x(Ciphertext& cSinx, Ciphertext& cCosx, long pBits);
 
+	/**
+	 * evaluation of Chebyshev series with baby steps T_1, ..., T_baby from T_(a + b) = 2 T_a T_b - T_(a - b)
+	 * and giant steps T_(2n) = 2 T_n^2 - 1 for baby = 2^EvalModPlan::logBabyStep(degree),
+	 * series is split recursively by giant steps, so it needs EvalModPlan::seriesMults key switches,
+	 * factor 2 of basis is taken by rescaling with pBits - 1
+	 * @param[in] cipher(u) with u in [-1, 1] and scale 2^pBits
+	 * @param[in] coeffs coefficients of T_0, ..., T_degree
+	 * @param[in] degree degree of series
+	 * @return cipher(sum coeffs[i] * T_i(u)) with scale 2^pBits
+	 */
+	Ciphertext evaluateChebyshev(Ciphertext& cipher, vector<RR>& coeffs, long degree, long pBits);
+
+	/**
+	 * removes q0 * I with Taylor approximation of sine and logI + logT double-angle steps,
+	 * or with Chebyshev approximation from evalModPlanMap if it has a plan for logI,
+	 * which must be made for the same logT
+	 */
 	Ciphertext removeIpart(Ciphertext& cipher, long logq0, long logT, long logI = 4);
 
 	void removeIpartAndEqual(Ciphertext& cipher, long logq0, long logT, long logI = 4);
 
-	Ciphertext bootstrap(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4);
+	/**
+	 * bootstrapping of cipher modulo 2^logq0
+	 * @param[in] logI log of bound of I after modulus raising, sparseLogI(sparseh) if sparse is set
+	 * @param[in] sparse if set, modulus is raised under sparse secret of addSparseKeys,
+	 * then BootKey must be made with precision logq0 + logI for this logI
+	 * @return cipher of the same message modulo 2^(logq - consumed bits)
+	 */
+	Ciphertext bootstrap(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
+
+	void bootstrapAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
+
+	/**
+	 * bootstrapping with tasks of scheduler: for full slots the even and odd halves run as
+	 * two concurrent tasks until the final sum, linear transforms spawn their products as nested tasks
+	 * @param[in] cipher
+	 * @param[in] scheduler task scheduler
+	 * @return bootstrapped cipher as in bootstrap
+	 */
+	Ciphertext bootstrapParallel(Ciphertext& cipher, TaskScheduler& scheduler, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
 
-	void bootstrapAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4);
+	void bootstrapParallelAndEqual(Ciphertext& cipher, TaskScheduler& scheduler, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
 
-	Ciphertext bootstrapOneReal(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4);
+	Ciphertext bootstrapOneReal(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
 
-	void bootstrapOneRealAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4);
+	void bootstrapOneRealAndEqual(Ciphertext& cipher, long logq0, long logq, long logT, long logI = 4, bool sparse = false);
 
 };
 
@@ -20,8 +20,7 @@ CZZ* SchemeAlgo::decryptSingleArray(SecretKey& secretKey, Ciphertext*& ciphers,
 Ciphertext SchemeAlgo::powerOf2(Ciphertext& cipher, const long precisionBits, const long logDegree) {
 	Ciphertext res = cipher;
 	for (long i = 0; i < logDegree; ++i) {
-		scheme.squareAndEqual(res);
-		scheme.reScaleByAndEqual(res, precisionBits);
+		scheme.squareAndRescaleAndEqual(res, precisionBits);
 	}
 	return res;
 }
@@ -30,8 +29,7 @@ Ciphertext* SchemeAlgo::powerOf2Extended(Ciphertext& cipher, const long precisio
 	Ciphertext* res = new Ciphertext[logDegree + 1];
 	res[0] = cipher;
 	for (long i = 1; i < logDegree + 1; ++i) {
-		res[i] = scheme.square(res[i-1]);
-		scheme.reScaleByAndEqual(res[i], precisionBits);
+		res[i] = scheme.squareAndRescale(res[i-1], precisionBits);
 	}
 	return res;
 }
@@ -48,8 +46,7 @@ Ciphertext SchemeAlgo::power(Ciphertext& cipher, const long precisionBits, const
 		Ciphertext tmp = power(cipher, precisionBits, remDegree);
 		long bitsDown = tmp.cbits - res.cbits;
 		scheme.modDownByAndEqual(tmp, bitsDown);
-		scheme.multAndEqual(res, tmp);
-		scheme.reScaleByAndEqual(res, precisionBits);
+		scheme.multAndRescaleAndEqual(res, tmp, precisionBits);
 	}
 	return res;
 }
@@ -65,8 +62,7 @@ Ciphertext* SchemeAlgo::powerExtended(Ciphertext& cipher, const long precisionBi
 		for (int j = 0; j < powi-1; ++j) {
 			long bitsDown = res[j].cbits - cpows[i].cbits;
 			res[idx] = scheme.modDownBy(res[j], bitsDown);
-			scheme.multAndEqual(res[idx], cpows[i]);
-			scheme.reScaleByAndEqual(res[idx++], precisionBits);
+			scheme.multAndRescaleAndEqual(res[idx++], cpows[i], precisionBits);
 		}
 	}
 	res[idx++] = cpows[logDegree];
@@ -74,8 +70,7 @@ Ciphertext* SchemeAlgo::powerExtended(Ciphertext& cipher, const long precisionBi
 	for (int i = 0; i < (degree - degree2); ++i) {
 		long bitsDown = res[i].cbits - cpows[logDegree].cbits;
 		res[idx] = scheme.modDownBy(res[i], bitsDown);
-		scheme.multAndEqual(res[idx], cpows[logDegree]);
-		scheme.reScaleByAndEqual(res[idx++], precisionBits);
+		scheme.multAndRescaleAndEqual(res[idx++], cpows[logDegree], precisionBits);
 	}
 	return res;
 }
@@ -89,8 +84,7 @@ Ciphertext SchemeAlgo::prodOfPo2(Ciphertext*& ciphers, const long precisionBits,
 		Ciphertext* tmp = new Ciphertext[powih];
 		NTL_EXEC_RANGE(powih, first, last);
 		for (long j = first; j < last; ++j) {
-			tmp[j] = scheme.mult(res[2 * j], res[2 * j + 1]);
-			scheme.reScaleByAndEqual(tmp[j], precisionBits);
+			tmp[j] = scheme.multAndRescale(res[2 * j], res[2 * j + 1], precisionBits);
 		}
 		NTL_EXEC_RANGE_END;
 		res = tmp;
@@ -114,8 +108,7 @@ Ciphertext SchemeAlgo::prod(Ciphertext*& ciphers, const long precisionBits, cons
 			if(isinit) {
 				long bitsDown = res.cbits - iprod.cbits;
 				scheme.modDownByAndEqual(res, bitsDown);
-				scheme.multAndEqual(res, iprod);
-				scheme.reScaleByAndEqual(res, precisionBits);
+				scheme.multAndRescaleAndEqual(res, iprod, precisionBits);
 			} else {
 				res = iprod;
 				isinit = true;
@@ -136,8 +129,7 @@ Ciphertext SchemeAlgo::sum(Ciphertext*& ciphers, const long size) {
 
 Ciphertext SchemeAlgo::distance(Ciphertext& cipher1, Ciphertext& cipher2, const long precisionBits) {
 	Ciphertext cres = scheme.sub(cipher1, cipher2);
-	scheme.squareAndEqual(cres);
-	scheme.reScaleByAndEqual(cres, precisionBits);
+	scheme.squareAndRescaleAndEqual(cres, precisionBits);
 	partialSlotsSumAndEqual(cres, cres.slots);
 	return cres;
 }
@@ -165,8 +157,7 @@ Ciphertext* SchemeAlgo::multAndModSwitchVec(Ciphertext*& ciphers1, Ciphertext*&
 	Ciphertext* res = new Ciphertext[size];
 	NTL_EXEC_RANGE(size, first, last);
 	for (long i = first; i < last; ++i) {
-		res[i] = scheme.mult(ciphers1[i], ciphers2[i]);
-		scheme.reScaleByAndEqual(res[i], precisionBits);
+		res[i] = scheme.multAndRescale(ciphers1[i], ciphers2[i], precisionBits);
 	}
 	NTL_EXEC_RANGE_END;
 	return res;
@@ -175,32 +166,33 @@ Ciphertext* SchemeAlgo::multAndModSwitchVec(Ciphertext*& ciphers1, Ciphertext*&
 void SchemeAlgo::multModSwitchAndEqualVec(Ciphertext*& ciphers1, Ciphertext*& ciphers2, const long precisionBits, const long size) {
 	NTL_EXEC_RANGE(size, first, last);
 	for (long i = first; i < last; ++i) {
-		scheme.multAndEqual(ciphers1[i], ciphers2[i]);
-		scheme.reScaleByAndEqual(ciphers1[i], precisionBits);
+		scheme.multAndRescaleAndEqual(ciphers1[i], ciphers2[i], precisionBits);
 	}
 	NTL_EXEC_RANGE_END;
 }
 
 Ciphertext SchemeAlgo::innerProd(Ciphertext*& ciphers1, Ciphertext*& ciphers2, const long precisionBits, const long size) {
-	Ciphertext cip = scheme.mult(ciphers1[size-1], ciphers2[size-1]);
+	Ciphertext3* cprods = new Ciphertext3[size];
 
-	NTL_EXEC_RANGE(size-1, first, last);
+	NTL_EXEC_RANGE(size, first, last);
 	for (long i = first; i < last; ++i) {
-		Ciphertext cprodi = scheme.mult(ciphers1[i], ciphers2[i]);
-		scheme.addAndEqual(cip, cprodi);
+		cprods[i] = scheme.multNoRelin(ciphers1[i], ciphers2[i]);
 	}
 	NTL_EXEC_RANGE_END;
 
+	for (long i = 1; i < size; ++i) {
+		scheme.addAndEqual(cprods[0], cprods[i]);
+	}
+	Ciphertext cip = scheme.relinearize(cprods[0]);
+	delete[] cprods;
+
 	scheme.reScaleByAndEqual(cip, precisionBits);
 	return cip;
 }
 
 Ciphertext SchemeAlgo::partialSlotsSum(Ciphertext& cipher, const long slots) {
 	Ciphertext res = cipher;
-	for (long i = 1; i < slots; i <<= 1) {
-		Ciphertext rot = scheme.leftRotateFast(cipher, i);
-		scheme.addAndEqual(res, rot);
-	}
+	partialSlotsSumAndEqual(res, slots);
 	return res;
 }
 
@@ -221,12 +213,10 @@ Ciphertext SchemeAlgo::inverse(Ciphertext& cipher, const long precisionBits, con
 	Ciphertext res = tmp;
 
 	for (long i = 1; i < steps; ++i) {
-		scheme.squareAndEqual(cpow);
-		scheme.reScaleByAndEqual(cpow, precisionBits);
+		scheme.squareAndRescaleAndEqual(cpow, precisionBits);
 		tmp = cpow;
 		scheme.addConstAndEqual(tmp, precision);
-		scheme.multAndEqual(tmp, res);
-		scheme.reScaleByAndEqual(tmp, precisionBits);
+		scheme.multAndRescaleAndEqual(tmp, res, precisionBits);
 		res = tmp;
 	}
 	return res;
@@ -242,12 +232,10 @@ Ciphertext* SchemeAlgo::inverseExtended(Ciphertext& cipher, const long precision
 	res[0] = tmp;
 
 	for (long i = 1; i < steps; ++i) {
-		scheme.squareAndEqual(cpow);
-		scheme.reScaleByAndEqual(cpow, precisionBits);
+		scheme.squareAndRescaleAndEqual(cpow, precisionBits);
 		tmp = cpow;
 		scheme.addConstAndEqual(tmp, precision);
-		scheme.multAndEqual(tmp, res[i - 1]);
-		scheme.reScaleByAndEqual(tmp, precisionBits);
+		scheme.multAndRescaleAndEqual(tmp, res[i - 1], precisionBits);
 		res[i] = tmp;
 	}
 	return res;
@@ -155,7 +155,7 @@ public:
 	//-----------------------------------------
 
 	/**
-	 * Calculating inner product of ciphers
+	 * Calculating inner product of ciphers, products are summed before linearization
 	 * @param[in] [cipher(m_1), cipher(m_2),...,cipher(m_size)]
 	 * @param[in] [cipher(n_1), cipher(n_2),...,cipher(n_size)]
 	 * @param[in] precision of initial m_i, n_i
@@ -0,0 +1,63 @@
+#include "ScratchArena.h"
+
+#include <stdexcept>
+
+ScratchArena& ScratchArena::local() {
+	static thread_local ScratchArena arena;
+	return arena;
+}
+
+ZZX& ScratchArena::poly() {
+	if(polysUsed == (long) polys.size()) {
+		polys.push_back(new ZZX());
+	}
+	return *polys[polysUsed++];
+}
+
+ZZ& ScratchArena::number() {
+	if(numbersUsed == (long) numbers.size()) {
+		numbers.push_back(new ZZ());
+	}
+	return *numbers[numbersUsed++];
+}
+
+uint64_t* ScratchArena::words(long len) {
+	if(wordsUsed == (long) buffers.size()) {
+		buffers.push_back(new uint64_t[len]);
+		buffersLen.push_back(len);
+	} else if(buffersLen[wordsUsed] < len) {
+		delete[] buffers[wordsUsed];
+		buffers[wordsUsed] = new uint64_t[len];
+		buffersLen[wordsUsed] = len;
+	}
+	return buffers[wordsUsed++];
+}
+
+void ScratchArena::clear() {
+	if(polysUsed != 0 || numbersUsed != 0 || wordsUsed != 0) {
+		throw runtime_error("scratch arena is cleared inside a frame");
+	}
+	for (long i = 0; i < (long) polys.size(); ++i) {
+		delete polys[i];
+	}
+	for (long i = 0; i < (long) numbers.size(); ++i) {
+		delete numbers[i];
+	}
+	for (long i = 0; i < (long) buffers.size(); ++i) {
+		delete[] buffers[i];
+	}
+	polys.clear();
+	numbers.clear();
+	buffers.clear();
+	buffersLen.clear();
+	polysUsed = 0;
+	numbersUsed = 0;
+	wordsUsed = 0;
+}
+
+ScratchArena::~ScratchArena() {
+	polysUsed = 0;
+	numbersUsed = 0;
+	wordsUsed = 0;
+	clear();
+}
@@ -0,0 +1,96 @@
+#ifndef HEAAN_SCRATCHARENA_H_
+#define HEAAN_SCRATCHARENA_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+using namespace NTL;
+
+/**
+ * Per-thread pool of temporaries for ring operations: polynomials, big integers and residue buffers.
+ * Temporaries are taken in stack order inside a Frame and go back to the pool when the frame ends,
+ * keeping their storage, so that repeated operations of the same size reuse the storage of their temporaries.
+ * This removes only allocations of the temporaries themselves: results of out-of-place operations
+ * and internal temporaries of NTL arithmetic are still allocated on the heap.
+ * Values of taken temporaries are left over from previous use and have to be overwritten
+ */
+class ScratchArena {
+public:
+
+	/**
+	 * Scope of temporaries: everything taken through a frame is given back by its destructor
+	 */
+	class Frame {
+	public:
+
+		Frame() : arena(local()), polysMark(arena.polysUsed), numbersMark(arena.numbersUsed), wordsMark(arena.wordsUsed) {}
+
+		~Frame() {
+			arena.polysUsed = polysMark;
+			arena.numbersUsed = numbersMark;
+			arena.wordsUsed = wordsMark;
+		}
+
+		ZZX& poly() { return arena.poly(); }
+
+		ZZ& number() { return arena.number(); }
+
+		uint64_t* words(long len) { return arena.words(len); }
+
+	private:
+
+		ScratchArena& arena;
+		long polysMark;
+		long numbersMark;
+		long wordsMark;
+
+		Frame(const Frame&);
+		Frame& operator=(const Frame&);
+	};
+
+	/**
+	 * @return arena of the calling thread
+	 */
+	static ScratchArena& local();
+
+	/**
+	 * @return temporary polynomial, allocated at the first use of its slot
+	 */
+	ZZX& poly();
+
+	/**
+	 * @return temporary integer, allocated at the first use of its slot
+	 */
+	ZZ& number();
+
+	/**
+	 * @param[in] len number of words
+	 * @return temporary buffer of at least len words, grown if its slot is smaller
+	 */
+	uint64_t* words(long len);
+
+	/**
+	 * frees pooled storage, only allowed outside of frames
+	 */
+	void clear();
+
+	~ScratchArena();
+
+private:
+
+	vector<ZZX*> polys;
+	vector<ZZ*> numbers;
+	vector<uint64_t*> buffers;
+	vector<long> buffersLen;
+
+	long polysUsed;
+	long numbersUsed;
+	long wordsUsed;
+
+	ScratchArena() : polysUsed(0), numbersUsed(0), wordsUsed(0) {}
+};
+
+#endif
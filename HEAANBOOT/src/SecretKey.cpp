@@ -4,3 +4,7 @@
 SecretKey::SecretKey(Params& params) {
 	NumUtils::sampleHWT(sx, params.N, params.h);
 }
+
+SecretKey::SecretKey(long N, long h) {
+	NumUtils::sampleHWT(sx, N, h);
+}
@@ -19,6 +19,13 @@ public:
 
 	SecretKey(Params& params);
 
+	/**
+	 * samples secret key with h nonzero coefficients
+	 * @param[in] N degree of the ring
+	 * @param[in] h hamming weight
+	 */
+	SecretKey(long N, long h);
+
 	//-----------------------------------------
 
 };
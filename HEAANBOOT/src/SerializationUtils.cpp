@@ -0,0 +1,313 @@
+#include "SerializationUtils.h"
+
+#include <stdexcept>
+
+void SerializationUtils::writeParams(ostream& out, Context& context) {
+	BinaryWriter writer(out);
+	writer.begin(RECORD_PARAMS);
+	writer.writeLong(context.logN);
+	writer.writeLong(context.logq);
+	writer.writeDouble(context.sigma);
+	writer.writeLong(context.h);
+	writer.writeLong(context.backend);
+	writer.end();
+}
+
+Params SerializationUtils::readParams(istream& in, long& backend) {
+	BinaryReader reader(in);
+	reader.begin(RECORD_PARAMS);
+	long logN = reader.readLong();
+	long logq = reader.readLong();
+	double sigma = reader.readDouble();
+	long h = reader.readLong();
+	backend = reader.readLong();
+	reader.end();
+	return Params(logN, logq, sigma, h);
+}
+
+void SerializationUtils::writeCiphertext(ostream& out, Ciphertext& cipher) {
+	BinaryWriter writer(out);
+	writer.begin(RECORD_CIPHERTEXT);
+	writer.writeLong(cipher.cbits);
+	writer.writeLong(cipher.slots);
+	writer.writeLong(cipher.isComplex);
+	long limbs = BinaryWriter::numLimbs(NumBits(cipher.mod));
+	writer.writeLong(limbs);
+	writer.writeZZ(cipher.mod, limbs);
+	long degree = max(cipher.ax.rep.length(), cipher.bx.rep.length());
+	writer.writePoly(cipher.ax, degree);
+	writer.writePoly(cipher.bx, degree);
+	writer.end();
+}
+
+Ciphertext SerializationUtils::readCiphertext(istream& in) {
+	BinaryReader reader(in);
+	reader.begin(RECORD_CIPHERTEXT);
+	Ciphertext cipher;
+	cipher.cbits = reader.readLong();
+	cipher.slots = reader.readLong();
+	cipher.isComplex = reader.readLong() != 0;
+	long limbs = reader.readLong();
+	reader.readZZ(cipher.mod, limbs);
+	reader.readPoly(cipher.ax);
+	reader.readPoly(cipher.bx);
+	reader.end();
+	return cipher;
+}
+
+void SerializationUtils::writeKey(ostream& out, Key& key, Context& context) {
+	BinaryWriter writer(out);
+	writer.begin(RECORD_KEY);
+	writeKeyPayload(writer, key, context);
+	writer.end();
+}
+
+Key SerializationUtils::readKey(istream& in, Context& context) {
+	BinaryReader reader(in);
+	reader.begin(RECORD_KEY);
+	Key key = readKeyPayload(reader, context);
+	reader.end();
+	return key;
+}
+
+void SerializationUtils::writeBootKey(ostream& out, BootKey& bootKey, Context& context) {
+	BinaryWriter writer(out);
+	writer.begin(RECORD_BOOTKEY);
+	writeBootKeyPayload(writer, bootKey, context);
+	writer.end();
+}
+
+BootKey SerializationUtils::readBootKey(istream& in, Context& context, DiagonalCache* cache) {
+	BinaryReader reader(in);
+	reader.begin(RECORD_BOOTKEY);
+	BootKey bootKey = readBootKeyPayload(reader, context, cache);
+	reader.end();
+	return bootKey;
+}
+
+void SerializationUtils::writeKeys(ostream& out, Scheme& scheme) {
+	BinaryWriter writer(out);
+	writer.begin(RECORD_KEYMAPS);
+	writer.writeLong(scheme.keyMap.size());
+	writer.writeLong(scheme.leftRotKeyMap.size());
+	writer.writeLong(scheme.bootKeyMap.size());
+	writer.end();
+
+	for (long m = KEYMAP_KEYS; m <= KEYMAP_LEFTROT; ++m) {
+		map<long, Key>& keys = m == KEYMAP_KEYS ? scheme.keyMap : scheme.leftRotKeyMap;
+		for (map<long, Key>::iterator it = keys.begin(); it != keys.end(); ++it) {
+			writer.begin(RECORD_KEY_ENTRY);
+			writer.writeLong(m);
+			writer.writeLong(it->first);
+			writeKeyPayload(writer, it->second, scheme.context);
+			writer.end();
+		}
+	}
+	for (map<long, BootKey>::iterator it = scheme.bootKeyMap.begin(); it != scheme.bootKeyMap.end(); ++it) {
+		writer.begin(RECORD_BOOTKEY_ENTRY);
+		writer.writeLong(it->first);
+		writeBootKeyPayload(writer, it->second, scheme.context);
+		writer.end();
+	}
+}
+
+void SerializationUtils::readKeys(istream& in, Scheme& scheme) {
+	BinaryReader reader(in);
+	reader.begin(RECORD_KEYMAPS);
+	long numKeys = reader.readLong() + reader.readLong();
+	long numBootKeys = reader.readLong();
+	reader.end();
+
+	for (long i = 0; i < numKeys; ++i) {
+		reader.begin(RECORD_KEY_ENTRY);
+		long m = reader.readLong();
+		long idx = reader.readLong();
+		if(m != KEYMAP_KEYS && m != KEYMAP_LEFTROT) {
+			throw runtime_error("unknown key map in binary record");
+		}
+		Key key = readKeyPayload(reader, scheme.context);
+		reader.end();
+		map<long, Key>& keys = m == KEYMAP_KEYS ? scheme.keyMap : scheme.leftRotKeyMap;
+		keys.erase(idx);
+		keys.insert(pair<long, Key>(idx, key));
+	}
+	bool lazy = false;
+	for (long i = 0; i < numBootKeys; ++i) {
+		reader.begin(RECORD_BOOTKEY_ENTRY);
+		long idx = reader.readLong();
+		BootKey bootKey = readBootKeyPayload(reader, scheme.context, &scheme.diagonalCache);
+		reader.end();
+		lazy = lazy || bootKey.cache != NULL;
+		scheme.bootKeyMap.erase(idx);
+		scheme.bootKeyMap.insert(pair<long, BootKey>(idx, bootKey));
+	}
+	if(lazy) {
+		scheme.diagonalCache.clear();
+	}
+}
+
+//-----------------------------------------
+
+void SerializationUtils::writeKeyPayload(BinaryWriter& writer, Key& key, Context& context) {
+	writer.writeLong(key.dnum);
+	writer.writeLong(key.logP);
+	if(!key.isHybrid()) {
+		writeKeyPolys(writer, key, context);
+		return;
+	}
+	for (long i = 0; i < key.dnum; ++i) {
+		writeKeyPolys(writer, key.digits[i], context);
+	}
+}
+
+Key SerializationUtils::readKeyPayload(BinaryReader& reader, Context& context) {
+	long dnum = reader.readLong();
+	long logP = reader.readLong();
+	if(dnum <= 0) {
+		return readKeyPolys(reader, context, context.logqq, context.logq);
+	}
+	if(logP <= 0 || dnum * logP < context.logq) {
+		throw runtime_error("hybrid key does not match context");
+	}
+	Key key(dnum, logP);
+	for (long i = 0; i < dnum; ++i) {
+		key.digits[i] = readKeyPolys(reader, context, context.logq + logP, logP + NumBits(dnum));
+	}
+	return key;
+}
+
+void SerializationUtils::writeKeyPolys(BinaryWriter& writer, Key& key, Context& context) {
+	writer.writeLong(key.isSeeded);
+	writer.writeLong(key.rbx ? 1 : 0);
+	if(key.isSeeded) {
+		writer.writeBytes(key.seed, SEED_BYTES);
+	} else {
+		writer.writePoly(key.ax, context.N);
+	}
+	writer.writePoly(key.bx, context.N);
+}
+
+Key SerializationUtils::readKeyPolys(BinaryReader& reader, Context& context, long logMod, long multBits) {
+	bool isSeeded = reader.readLong() != 0;
+	bool hasResidues = reader.readLong() != 0;
+	unsigned char seed[SEED_BYTES];
+	ZZX ax, bx;
+	if(isSeeded) {
+		reader.readBytes(seed, SEED_BYTES);
+		NumUtils::sampleUniform2Seeded(ax, context.N, logMod, seed);
+	} else {
+		reader.readPoly(ax);
+	}
+	reader.readPoly(bx);
+	if(bx.rep.length() != context.N || ax.rep.length() != context.N) {
+		throw runtime_error("key does not match context");
+	}
+	const unsigned char* seedp = isSeeded ? seed : NULL;
+	return hasResidues ? Key(ax, bx, context, seedp, multBits) : Key(ax, bx, seedp);
+}
+
+void SerializationUtils::writeBootKeyPayload(BinaryWriter& writer, BootKey& bootKey, Context& context) {
+	writer.writeLong(bootKey.pBits);
+	writer.writeLong(bootKey.logSize);
+	writer.writeLong(bootKey.levels);
+	writer.writeLong(bootKey.cache != NULL);
+	if(bootKey.cache != NULL) return;
+
+	if(bootKey.levels == 0) {
+		long lpow = 1 << bootKey.logSize;
+		for (long j = 0; j < lpow; ++j) {
+			writeSparsePoly(writer, bootKey.pvec[j]);
+			writeSparsePoly(writer, bootKey.pvecInv[j]);
+		}
+		return;
+	}
+	for (long i = 0; i < bootKey.levels; ++i) {
+		writer.writeLong(bootKey.ctsNum[i]);
+		for (long j = 0; j < bootKey.ctsNum[i]; ++j) {
+			writer.writeLong(bootKey.ctsRot[i][j]);
+			writeSparsePoly(writer, bootKey.ctsPvec[i][j]);
+		}
+		writer.writeLong(bootKey.stcNum[i]);
+		for (long j = 0; j < bootKey.stcNum[i]; ++j) {
+			writer.writeLong(bootKey.stcRot[i][j]);
+			writeSparsePoly(writer, bootKey.stcPvec[i][j]);
+		}
+	}
+}
+
+BootKey SerializationUtils::readBootKeyPayload(BinaryReader& reader, Context& context, DiagonalCache* cache) {
+	long pBits = reader.readLong();
+	long logSize = reader.readLong();
+	long levels = reader.readLong();
+	bool lazy = reader.readLong() != 0;
+	if(logSize < 0 || logSize >= context.logN || levels < 0 || levels > logSize) {
+		throw runtime_error("BootKey does not match context");
+	}
+	if(lazy) {
+		return cache != NULL ? BootKey(context, pBits, logSize, cache) : BootKey(context, pBits, logSize);
+	}
+
+	BootKey bootKey;
+	bootKey.pBits = pBits;
+	bootKey.logSize = logSize;
+	bootKey.levels = levels;
+	if(levels == 0) {
+		long lpow = 1 << logSize;
+		bootKey.pvec.resize(lpow);
+		bootKey.pvecInv.resize(lpow);
+		for (long j = 0; j < lpow; ++j) {
+			bootKey.pvec[j] = readSparsePoly(reader, context);
+			bootKey.pvecInv[j] = readSparsePoly(reader, context);
+		}
+		return bootKey;
+	}
+	bootKey.ctsNum.resize(levels);
+	bootKey.ctsRot.resize(levels);
+	bootKey.ctsPvec.resize(levels);
+	bootKey.stcNum.resize(levels);
+	bootKey.stcRot.resize(levels);
+	bootKey.stcPvec.resize(levels);
+	long size = 1 << logSize;
+	for (long i = 0; i < levels; ++i) {
+		for (long s = 0; s < 2; ++s) {
+			long num = reader.readLong();
+			if(num < 0 || num > size) {
+				throw runtime_error("BootKey does not match context");
+			}
+			vector<long> rot(num);
+			vector<SparsePoly> pvec(num);
+			for (long j = 0; j < num; ++j) {
+				rot[j] = reader.readLong();
+				pvec[j] = readSparsePoly(reader, context);
+			}
+			(s == 0 ? bootKey.ctsNum : bootKey.stcNum)[i] = num;
+			(s == 0 ? bootKey.ctsRot : bootKey.stcRot)[i] = rot;
+			(s == 0 ? bootKey.ctsPvec : bootKey.stcPvec)[i] = pvec;
+		}
+	}
+	return bootKey;
+}
+
+void SerializationUtils::writeSparsePoly(BinaryWriter& writer, SparsePoly& poly) {
+	long limbs = BinaryWriter::numLimbs(poly.bits);
+	writer.writeLong(poly.gap);
+	writer.writeLong(limbs);
+	ZZ* coeffs = poly.coeffs.get();
+	for (long i = 0; i < poly.num; ++i) {
+		writer.writeZZ(coeffs[i], limbs);
+	}
+}
+
+SparsePoly SerializationUtils::readSparsePoly(BinaryReader& reader, Context& context) {
+	long gap = reader.readLong();
+	long limbs = reader.readLong();
+	if(gap <= 0 || gap > context.N || context.N % gap != 0 || limbs <= 0 || limbs > (1L << 16)) {
+		throw runtime_error("sparse polynomial does not match context");
+	}
+	ZZX p;
+	p.SetLength(context.N);
+	for (long i = 0; i < context.N / gap; ++i) {
+		reader.readZZ(p.rep[i * gap], limbs);
+	}
+	return SparsePoly(p, gap, context);
+}
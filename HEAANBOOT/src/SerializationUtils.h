@@ -0,0 +1,101 @@
+#ifndef HEAAN_SERIALIZATIONUTILS_H_
+#define HEAAN_SERIALIZATIONUTILS_H_
+
+#include <iostream>
+
+#include "BinaryStream.h"
+#include "BootKey.h"
+#include "Ciphertext.h"
+#include "Context.h"
+#include "Key.h"
+#include "Params.h"
+#include "Scheme.h"
+
+using namespace std;
+using namespace NTL;
+
+static const uint32_t RECORD_PARAMS = 1;
+static const uint32_t RECORD_CIPHERTEXT = 2;
+static const uint32_t RECORD_KEY = 3;
+static const uint32_t RECORD_BOOTKEY = 4;
+static const uint32_t RECORD_KEYMAPS = 5; ///< numbers of entries in key maps of Scheme, followed by their records
+static const uint32_t RECORD_KEY_ENTRY = 6; ///< map and index of key followed by key
+static const uint32_t RECORD_BOOTKEY_ENTRY = 7; ///< index of BootKey followed by BootKey
+
+static const long KEYMAP_KEYS = 0; ///< Scheme::keyMap
+static const long KEYMAP_LEFTROT = 1; ///< Scheme::leftRotKeyMap
+
+/**
+ * Binary serialization in records of BinaryWriter.
+ * Seeded keys are written in compressed form: seed and bx only.
+ * Residues in NTT form are not written, they are recomputed by readers for the given Context
+ */
+class SerializationUtils {
+public:
+
+	/**
+	 * writes parameters and backend of context
+	 */
+	static void writeParams(ostream& out, Context& context);
+
+	/**
+	 * @param[out] backend ring multiplication backend of written context
+	 * @return parameters of written context
+	 */
+	static Params readParams(istream& in, long& backend);
+
+	static void writeCiphertext(ostream& out, Ciphertext& cipher);
+
+	static Ciphertext readCiphertext(istream& in);
+
+	static void writeKey(ostream& out, Key& key, Context& context);
+
+	static Key readKey(istream& in, Context& context);
+
+	/**
+	 * writes stored diagonals of bootKey, lazy BootKey is written without diagonals
+	 */
+	static void writeBootKey(ostream& out, BootKey& bootKey, Context& context);
+
+	/**
+	 * @param[in] cache cache for lazy BootKey, if NULL lazy BootKey is generated in full
+	 */
+	static BootKey readBootKey(istream& in, Context& context, DiagonalCache* cache = NULL);
+
+	/**
+	 * writes keyMap, leftRotKeyMap and bootKeyMap of scheme as one record per key
+	 */
+	static void writeKeys(ostream& out, Scheme& scheme);
+
+	/**
+	 * reads keys written by writeKeys into key maps of scheme, replacing keys with the same index
+	 */
+	static void readKeys(istream& in, Scheme& scheme);
+
+	//-----------------------------------------
+
+	/**
+	 * writes number of digits and special modulus of key followed by polynomials of key or of its digit keys
+	 */
+	static void writeKeyPayload(BinaryWriter& writer, Key& key, Context& context);
+
+	static Key readKeyPayload(BinaryReader& reader, Context& context);
+
+	static void writeKeyPolys(BinaryWriter& writer, Key& key, Context& context);
+
+	/**
+	 * @param[in] logMod log of modulus of key, seeded ax is sampled with this number of bits
+	 * @param[in] multBits bound on number of bits in polynomials multiplied by key, used for residues
+	 */
+	static Key readKeyPolys(BinaryReader& reader, Context& context, long logMod, long multBits);
+
+	static void writeBootKeyPayload(BinaryWriter& writer, BootKey& bootKey, Context& context);
+
+	static BootKey readBootKeyPayload(BinaryReader& reader, Context& context, DiagonalCache* cache);
+
+	static void writeSparsePoly(BinaryWriter& writer, SparsePoly& poly);
+
+	static SparsePoly readSparsePoly(BinaryReader& reader, Context& context);
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include "SparsePoly.h"
+
+SparsePoly::SparsePoly(ZZX& p, long gap, Context& context) : N(context.N), gap(gap), bits(0), np(0) {
+	num = N / gap;
+	coeffs = shared_ptr<ZZ>(new ZZ[num], default_delete<ZZ[]>());
+	ZZ* c = coeffs.get();
+	long len = p.rep.length();
+	for (long i = 0; i < num && i * gap < len; ++i) {
+		c[i] = p.rep[i * gap];
+		bits = max(bits, NumBits(c[i]));
+	}
+
+	RingMultiplier* multiplier = context.multiplier;
+	if(multiplier != NULL) {
+		np = multiplier->numPrimes(bits + context.logq + context.logN);
+		if(np < 0) {
+			np = 0;
+			return;
+		}
+		rx = shared_ptr<uint64_t>(new uint64_t[np << context.logN], default_delete<uint64_t[]>());
+		multiplier->toNTT(rx.get(), p, np);
+	}
+}
+
+void SparsePoly::expand(ZZX& p) {
+	p.SetLength(N);
+	for (long i = 0; i < N; ++i) {
+		clear(p.rep[i]);
+	}
+	ZZ* c = coeffs.get();
+	for (long i = 0; i < num; ++i) {
+		p.rep[i * gap] = c[i];
+	}
+	p.normalize();
+}
@@ -0,0 +1,48 @@
+#ifndef HEAAN_SPARSEPOLY_H_
+#define HEAAN_SPARSEPOLY_H_
+
+#include <NTL/ZZ.h>
+#include <NTL/ZZX.h>
+
+#include <memory>
+
+#include "Context.h"
+
+using namespace NTL;
+
+static const long SPARSE_DIRECT_NUM = 64; ///< sparse polynomials with at most this many coefficients are multiplied without transforms
+
+/**
+ * Polynomial in Z[X] / (X^N + 1) with nonzero coefficients only at multiples of gap,
+ * as encodings of vectors with N / gap / 2 slots are.
+ * Only N / gap coefficients are stored, and residues in NTT form are kept for the RNS backend
+ */
+class SparsePoly {
+public:
+	long N;
+	long gap; ///< nonzero coefficients are at multiples of gap
+	long num; ///< number of stored coefficients, N / gap
+	shared_ptr<ZZ> coeffs; ///< coeffs.get()[i] is coefficient of X^(i * gap), shared by copies
+	long bits; ///< bound on number of bits in coefficients
+
+	shared_ptr<uint64_t> rx; ///< residues in NTT form shared by copies, empty if Context has no RNS multiplier
+	long np; ///< number of primes in rx
+
+	SparsePoly() : N(0), gap(1), num(0), bits(0), np(0) {}
+
+	/**
+	 * compacts p, coefficients of p out of multiples of gap are dropped,
+	 * enough residues are precomputed for multiplication by polynomials modulo context.q
+	 * @param[in] p polynomial
+	 * @param[in] gap divides N
+	 * @param[in] context context
+	 */
+	SparsePoly(ZZX& p, long gap, Context& context);
+
+	/**
+	 * @param[out] p polynomial of degree less than N with coefficients of this
+	 */
+	void expand(ZZX& p);
+};
+
+#endif
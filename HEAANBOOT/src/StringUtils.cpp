@@ -56,3 +56,20 @@ void StringUtils::showcompare(CZZ& val1, CZZ*& vals2, long size, string prefix)
 		cout << "---------------------" << endl;
 	}
 }
+
+//-----------------------------------------
+
+long StringUtils::showerror(CZZ*& vals1, CZZ*& vals2, long size, string prefix) {
+	long errBits = 0;
+	for (long i = 0; i < size; ++i) {
+		CZZ e = vals1[i] - vals2[i];
+		errBits = max(errBits, max(NumBits(e.r), NumBits(e.i)));
+	}
+	cout << prefix << ": max error bits = " << errBits << endl;
+	return errBits;
+}
+
+bool StringUtils::showcheck(bool passed, string prefix) {
+	cout << (passed ? "PASSED: " : "FAILED: ") << prefix << endl;
+	return passed;
+}
@@ -59,6 +59,25 @@ public:
 
 	//-----------------------------------------
 
+	/**
+	 * prints in console max bit length of pairwise errors (val1[i]-val2[i])
+	 * @param[in] array of CZZ val
+	 * @param[in] array of CZZ val
+	 * @param[in] string prefix
+	 * @return max bit length of errors, 0 if arrays are equal
+	 */
+	static long showerror(CZZ*& vals1, CZZ*& vals2, long size, string prefix);
+
+	/**
+	 * prints in console result of check
+	 * @param[in] result of check
+	 * @param[in] string prefix
+	 * @return result of check
+	 */
+	static bool showcheck(bool passed, string prefix);
+
+	//-----------------------------------------
+
 };
 
 #endif
@@ -0,0 +1,104 @@
+#include "TaskScheduler.h"
+
+static thread_local TaskScheduler* currentScheduler = NULL;
+static thread_local long currentWorker = -1;
+
+TaskScheduler::TaskScheduler(long numThreads) : numThreads(numThreads), stop(false), queued(0) {
+	for (long i = 0; i <= numThreads; ++i) {
+		queues.push_back(new TaskQueue());
+	}
+	for (long i = 0; i < numThreads; ++i) {
+		threads.push_back(thread(&TaskScheduler::workerLoop, this, i));
+	}
+}
+
+long TaskScheduler::currentQueue() {
+	return currentScheduler == this ? currentWorker : numThreads;
+}
+
+void TaskScheduler::spawn(TaskGroup& group, const function<void()>& task) {
+	group.pending++;
+	TaskQueue* queue = queues[currentQueue()];
+	{
+		lock_guard<mutex> guard(queue->lock);
+		Task t = {task, &group};
+		queue->tasks.push_back(t);
+	}
+	queued++;
+	notify(false);
+}
+
+void TaskScheduler::wait(TaskGroup& group) {
+	long self = currentQueue();
+	while (group.pending > 0) {
+		if(!runOne(self)) {
+			unique_lock<mutex> guard(sleepLock);
+			sleepCond.wait(guard, [this, &group]{ return group.pending == 0 || queued > 0; });
+		}
+	}
+}
+
+bool TaskScheduler::runOne(long self) {
+	Task task;
+	bool found = false;
+	long size = queues.size();
+	if(self < numThreads) {
+		TaskQueue* own = queues[self];
+		lock_guard<mutex> guard(own->lock);
+		if(!own->tasks.empty()) {
+			task = own->tasks.back();
+			own->tasks.pop_back();
+			found = true;
+		}
+	}
+	for (long i = 1; i <= size && !found; ++i) {
+		TaskQueue* other = queues[(self + i) % size];
+		lock_guard<mutex> guard(other->lock);
+		if(!other->tasks.empty()) {
+			task = other->tasks.front();
+			other->tasks.pop_front();
+			found = true;
+		}
+	}
+	if(!found) return false;
+	queued--;
+	task.run();
+	if(--task.group->pending == 0) {
+		notify(true);
+	}
+	return true;
+}
+
+void TaskScheduler::notify(bool all) {
+	{
+		// counters change outside of sleepLock, taking it here keeps sleeping threads from missing the change
+		lock_guard<mutex> guard(sleepLock);
+	}
+	if(all) {
+		sleepCond.notify_all();
+	} else {
+		sleepCond.notify_one();
+	}
+}
+
+void TaskScheduler::workerLoop(long self) {
+	currentScheduler = this;
+	currentWorker = self;
+	while (!stop) {
+		if(!runOne(self)) {
+			unique_lock<mutex> guard(sleepLock);
+			sleepCond.wait(guard, [this]{ return stop || queued > 0; });
+		}
+	}
+}
+
+TaskScheduler::~TaskScheduler() {
+	stop = true;
+	notify(true);
+	for (long i = 0; i < numThreads; ++i) {
+		threads[i].join();
+	}
+	for (long i = 0; i <= numThreads; ++i) {
+		delete queues[i];
+	}
+}
@@ -0,0 +1,97 @@
+#ifndef HEAAN_TASKSCHEDULER_H_
+#define HEAAN_TASKSCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Counter of unfinished tasks spawned in a group
+ */
+class TaskGroup {
+public:
+
+	atomic<long> pending;
+
+	TaskGroup() : pending(0) {}
+};
+
+/**
+ * Pool of worker threads with work stealing: every worker owns a deque of tasks,
+ * runs its newest task first and steals the oldest task of another worker when idle.
+ * A thread waiting for a group runs pending tasks meanwhile,
+ * so tasks can spawn and wait for nested tasks without blocking workers,
+ * and sleeps until a task is queued or the group is finished when there is nothing to run
+ */
+class TaskScheduler {
+public:
+
+	long numThreads; ///< number of worker threads, 0 runs all tasks in waiting threads
+
+	/**
+	 * @param[in] numThreads number of worker threads
+	 */
+	TaskScheduler(long numThreads);
+
+	/**
+	 * adds task to group, task is queued to the calling worker or to the shared queue
+	 * @param[in, out] group group of task
+	 * @param[in] task task
+	 */
+	void spawn(TaskGroup& group, const function<void()>& task);
+
+	/**
+	 * runs pending tasks until all tasks of group are finished
+	 * @param[in] group group of tasks
+	 */
+	void wait(TaskGroup& group);
+
+	virtual ~TaskScheduler();
+
+private:
+
+	struct Task {
+		function<void()> run;
+		TaskGroup* group;
+	};
+
+	struct TaskQueue {
+		mutex lock;
+		deque<Task> tasks;
+	};
+
+	vector<TaskQueue*> queues; ///< queues of workers followed by the shared queue of other threads
+	vector<thread> threads;
+
+	atomic<bool> stop;
+	atomic<long> queued; ///< number of tasks in all queues
+	mutex sleepLock;
+	condition_variable sleepCond;
+
+	/**
+	 * @return index of queue owned by the calling thread
+	 */
+	long currentQueue();
+
+	/**
+	 * runs one task from own queue or stolen from other queues
+	 * @return false if all queues are empty
+	 */
+	bool runOne(long self);
+
+	/**
+	 * wakes sleeping threads after queued tasks or pending tasks of a group changed
+	 * @param[in] all wakes all threads if true, one thread otherwise
+	 */
+	void notify(bool all);
+
+	void workerLoop(long self);
+};
+
+#endif
@@ -4,22 +4,122 @@
 #include <NTL/RR.h>
 #include <NTL/ZZ.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
 #include "Common.h"
 #include "Ciphertext.h"
 #include "CZZ.h"
 #include "EvaluatorUtils.h"
+#include "KeyStore.h"
 #include "NumUtils.h"
 #include "Params.h"
 #include "Scheme.h"
 #include "SchemeAlgo.h"
 #include "SecretKey.h"
+#include "SerializationUtils.h"
 #include "StringUtils.h"
 #include "TimeUtils.h"
 #include "Context.h"
+#include "RingMultiplier.h"
+#include "TaskScheduler.h"
 
 using namespace std;
 using namespace NTL;
 
+/**
+ * true if ciphers are at the same level and equal modulo their mod
+ */
+static bool isEqualCipher(Ciphertext& cipher1, Ciphertext& cipher2, long N) {
+	if(cipher1.cbits != cipher2.cbits || cipher1.mod != cipher2.mod) return false;
+	for (long i = 0; i < N; ++i) {
+		if(rem(coeff(cipher1.ax, i) - coeff(cipher2.ax, i), cipher1.mod) != 0) return false;
+		if(rem(coeff(cipher1.bx, i) - coeff(cipher2.bx, i), cipher1.mod) != 0) return false;
+	}
+	return true;
+}
+
+/**
+ * true if key maps have the same indices and equal ax and bx
+ */
+static bool isEqualKeys(map<long, Key>& keys1, map<long, Key>& keys2) {
+	if(keys1.size() != keys2.size()) return false;
+	for (map<long, Key>::iterator it = keys1.begin(); it != keys1.end(); ++it) {
+		map<long, Key>::iterator jt = keys2.find(it->first);
+		if(jt == keys2.end() || it->second.ax != jt->second.ax || it->second.bx != jt->second.bx) return false;
+	}
+	return true;
+}
+
+static bool isEqualSparse(vector<SparsePoly>& pvec1, vector<SparsePoly>& pvec2) {
+	if(pvec1.size() != pvec2.size()) return false;
+	for (size_t k = 0; k < pvec1.size(); ++k) {
+		SparsePoly& p1 = pvec1[k];
+		SparsePoly& p2 = pvec2[k];
+		if(p1.gap != p2.gap || p1.num != p2.num || p1.bits != p2.bits || p1.np != p2.np) return false;
+		for (long i = 0; i < p1.num; ++i) {
+			if(p1.coeffs.get()[i] != p2.coeffs.get()[i]) return false;
+		}
+		for (long i = 0; i < p1.np * p1.N; ++i) {
+			if(p1.rx.get()[i] != p2.rx.get()[i]) return false;
+		}
+	}
+	return true;
+}
+
+static bool isEqualBootKey(BootKey& key1, BootKey& key2) {
+	if(key1.levels != key2.levels || key1.ctsNum != key2.ctsNum || key1.ctsRot != key2.ctsRot
+			|| key1.stcNum != key2.stcNum || key1.stcRot != key2.stcRot) return false;
+	if(!isEqualSparse(key1.pvec, key2.pvec) || !isEqualSparse(key1.pvecInv, key2.pvecInv)) return false;
+	for (long i = 0; i < key1.levels; ++i) {
+		if(!isEqualSparse(key1.ctsPvec[i], key2.ctsPvec[i]) || !isEqualSparse(key1.stcPvec[i], key2.stcPvec[i])) return false;
+	}
+	return true;
+}
+
+/**
+ * dense CoeffToSlot or SlotToCoeff as in Scheme::linearTransformAndEqual,
+ * with diagonals of BootKey expanded to full polynomials as they were stored before SparsePoly
+ */
+static void linearTransformExpandedAndEqual(Scheme& scheme, Ciphertext& cipher, long size, bool inv) {
+	long logSize = log2(size);
+	long logSizeh = logSize / 2;
+	long k = 1 << logSizeh;
+	long m = 1 << (logSize - logSizeh);
+	BootKey& bootKey = scheme.bootKeyMap.at(logSize);
+
+	long* rotSlotsVec = new long[k];
+	for (long i = 0; i < k; ++i) {
+		rotSlotsVec[i] = i;
+	}
+	Ciphertext* cipherRotVec = scheme.leftRotateHoisted(cipher, rotSlotsVec, k);
+	delete[] rotSlotsVec;
+
+	ZZX diag;
+	for (long i = 0; i < m; ++i) {
+		long ki = k * i;
+		bootKey.diagonal(scheme.context, ki, inv)->expand(diag);
+		Ciphertext ci0 = scheme.multByPoly(cipherRotVec[0], diag);
+		for (long j = 1; j < k; ++j) {
+			bootKey.diagonal(scheme.context, j + ki, inv)->expand(diag);
+			Ciphertext cij = scheme.multByPoly(cipherRotVec[j], diag);
+			scheme.addAndEqual(ci0, cij);
+		}
+		if(i == 0) {
+			cipher = ci0;
+		} else {
+			scheme.leftRotateAndEqualFast(ci0, ki);
+			scheme.addAndEqual(cipher, ci0);
+		}
+	}
+	delete[] cipherRotVec;
+}
+
 //-----------------------------------------
 
 void TestScheme::testEncodeBatch(long logN, long logq, long precisionBits, long logSlots) {
@@ -48,6 +148,70 @@ void TestScheme::testEncodeBatch(long logN, long logq, long precisionBits, long
 	cout << "!!! END TEST ENCODE BATCH !!!" << endl;
 }
 
+bool TestScheme::testEncodePrecision(long logN, long logq, long logSlots) {
+	cout << "!!! START TEST ENCODE PRECISION !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long doubleslots = slots << 1;
+	long gap = context.N / doubleslots;
+	string names[2] = {"double", "long double"};
+	long bitsList[2] = {30, FFT_DOUBLE_BITS + 2};
+	bool passed = true;
+	for (long k = 0; k < 2; ++k) {
+		long bits = bitsList[k];
+		if(bits > FFT_LONG_DOUBLE_BITS - logSlots - 3) {
+			cout << "SKIPPED: " << names[k] << " path for " << bits << " bits" << endl;
+			continue;
+		}
+		CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, bits);
+		Plaintext msg = scheme.encode(mvec, slots, logq);
+
+		CZZ* gvals = new CZZ[doubleslots];
+		for (long i = 0; i < slots; ++i) {
+			long jdx = (context.rotGroup[i] % (slots << 2) - 1) / 2;
+			gvals[jdx] = mvec[i] << context.logq;
+			gvals[doubleslots - jdx - 1] = mvec[i].conjugate() << context.logq;
+		}
+		NumUtils::fftSpecialInv(gvals, doubleslots, context.ksiPowsr, context.ksiPowsi, context.M);
+		long encodeBits = 0;
+		for (long i = 0; i < doubleslots; ++i) {
+			encodeBits = max(encodeBits, NumBits(coeff(msg.mx, i * gap) - gvals[i].r));
+		}
+		cout << names[k] << " path, " << bits << " bits: encoding differs from RR path in " << encodeBits << " bits" << endl;
+		passed &= StringUtils::showcheck(encodeBits <= logq, names[k] + " encoding differs from RR path below unit of message");
+
+		Ring2Utils::rightShiftRoundAndEqual(msg.mx, context.logq, context.N);
+		CZZ* dvec = scheme.decode(msg);
+		CZZ* rvec = new CZZ[slots];
+		for (long i = 0; i < slots; ++i) {
+			RR re = to_RR(0);
+			RR im = to_RR(0);
+			for (long j = 0; j < doubleslots; ++j) {
+				long deg = (j * gap * context.rotGroup[i]) % context.M;
+				RR c = to_RR(coeff(msg.mx, j * gap));
+				re += c * context.ksiPowsr[deg];
+				im += c * context.ksiPowsi[deg];
+			}
+			rvec[i] = CZZ(RoundToZZ(re), RoundToZZ(im));
+		}
+		long decodeBits = StringUtils::showerror(dvec, rvec, slots, names[k] + " decoding against RR evaluation");
+		passed &= StringUtils::showcheck(decodeBits <= 1, names[k] + " decoding differs from RR evaluation by at most 1");
+
+		delete[] mvec;
+		delete[] gvals;
+		delete[] dvec;
+		delete[] rvec;
+	}
+	//-----------------------------------------
+	cout << "!!! END TEST ENCODE PRECISION !!!" << endl;
+	return passed;
+}
+
 //-----------------------------------------
 
 void TestScheme::testConjugateBatch(long logN, long logq, long precisionBits, long logSlots) {
@@ -211,6 +375,46 @@ void TestScheme::testSlotsSum(long logN, long logq, long precisionBits, long log
 	cout << "!!! END TEST SLOTS SUM !!!" << endl;
 }
 
+bool TestScheme::testPartialSlotsSum(long logN, long logq, long precisionBits, long logSlots) {
+	cout << "!!! START TEST PARTIAL SLOTS SUM !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	SchemeAlgo algo(scheme);
+	scheme.addLeftRotKeys(secretKey);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	//-----------------------------------------
+	bool passed = true;
+	for (long sumSlots = 2; sumSlots <= slots; sumSlots <<= 1) {
+		string prefix = "partial sums of " + to_string(sumSlots) + " slots";
+		Ciphertext csum = algo.partialSlotsSum(cipher, sumSlots);
+		Ciphertext csumEqual = cipher;
+		algo.partialSlotsSumAndEqual(csumEqual, sumSlots);
+		passed &= StringUtils::showcheck(isEqualCipher(csum, csumEqual, context.N), prefix + " equal to partialSlotsSumAndEqual");
+
+		CZZ* msum = new CZZ[slots];
+		for (long i = 0; i < slots; ++i) {
+			for (long j = 0; j < sumSlots; ++j) {
+				msum[i] += mvec[(i + j) % slots];
+			}
+		}
+		CZZ* dsum = scheme.decrypt(secretKey, csum);
+		long errBits = StringUtils::showerror(msum, dsum, slots, prefix);
+		passed &= StringUtils::showcheck(errBits < precisionBits / 2, prefix + " decrypt to sums");
+		delete[] msum;
+		delete[] dsum;
+	}
+	//-----------------------------------------
+	delete[] mvec;
+	cout << "!!! END TEST PARTIAL SLOTS SUM !!!" << endl;
+	return passed;
+}
+
 
 //-----------------------------------------
 
@@ -256,6 +460,78 @@ void TestScheme::testPowerOf2Batch(long logN, long logq, long precisionBits, lon
 	cout << "!!! END TEST POWER OF 2 BATCH !!!" << endl;
 }
 
+bool TestScheme::testRescaleRoundingBatch(long logN, long logq, long precisionBits, long logDegree, long logSlots) {
+	cout << "!!! START TEST RESCALE ROUNDING BATCH !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	SchemeAlgo algo(scheme);
+	//-----------------------------------------
+	long slots = 1 << logSlots;
+	CZZ* mvec = new CZZ[slots];
+	CZZ* mpow = new CZZ[slots];
+
+	for (long i = 0; i < slots; ++i) {
+		RR angle = random_RR();
+		RR mr = cos(angle * 2 * Pi);
+		RR mi = sin(angle * 2 * Pi);
+		mvec[i] = EvaluatorUtils::evalCZZ(mr, mi, precisionBits);
+		mpow[i] = EvaluatorUtils::evalCZZPow2(mr, mi, logDegree, precisionBits);
+	}
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	//-----------------------------------------
+	long modes[2] = {RESCALE_TRUNCATE, RESCALE_ROUND};
+	string names[2] = {"truncate", "round"};
+	long errBits[2] = {0, 0};
+	bool passed = true;
+	ZZ scale = power2_ZZ(precisionBits);
+	ZZ half = power2_ZZ(precisionBits - 1);
+	for (long k = 0; k < 2; ++k) {
+		scheme.rescaleMode = modes[k];
+		Ciphertext cmult = scheme.mult(cipher, cipher);
+		Ciphertext cres = scheme.reScaleBy(cmult, precisionBits);
+		Ciphertext cref = cmult;
+		for (long i = 0; i < context.N; ++i) {
+			ZZ ax = coeff(cmult.ax, i);
+			ZZ bx = coeff(cmult.bx, i);
+			if(modes[k] == RESCALE_ROUND) {
+				SetCoeff(cref.ax, i, (ax + half) / scale);
+				SetCoeff(cref.bx, i, (bx + half) / scale);
+			} else {
+				SetCoeff(cref.ax, i, ax >> precisionBits);
+				SetCoeff(cref.bx, i, bx >> precisionBits);
+			}
+		}
+		cref.cbits -= precisionBits;
+		cref.mod >>= precisionBits;
+		passed &= StringUtils::showcheck(isEqualCipher(cres, cref, context.N), "reScaleBy with " + names[k] + " equal to division of coefficients");
+		Ciphertext cfused = scheme.multAndRescale(cipher, cipher, precisionBits);
+		passed &= StringUtils::showcheck(isEqualCipher(cres, cfused, context.N), "multAndRescale with " + names[k] + " equal to mult and reScaleBy");
+
+		timeutils.start("Power of 2 batch with " + names[k]);
+		Ciphertext cpow = algo.powerOf2(cipher, precisionBits, logDegree);
+		timeutils.stop("Power of 2 batch with " + names[k]);
+
+		CZZ* dpow = scheme.decrypt(secretKey, cpow);
+		for (long i = 0; i < slots; ++i) {
+			CZZ diff = mpow[i] - dpow[i];
+			errBits[k] = max(errBits[k], max(NumBits(diff.r), NumBits(diff.i)));
+		}
+		cout << names[k] << ": max error bits = " << errBits[k] << " of " << precisionBits << endl;
+		delete[] dpow;
+	}
+	scheme.rescaleMode = RESCALE_TRUNCATE;
+	passed &= StringUtils::showcheck(errBits[0] < precisionBits / 2 && errBits[1] < precisionBits / 2, "power keeps precision in both modes");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] mpow;
+	cout << "!!! END TEST RESCALE ROUNDING BATCH !!!" << endl;
+	return passed;
+}
+
 //-----------------------------------------
 
 void TestScheme::testPowerBatch(long logN, long logq, long precisionBits, long degree, long logSlots) {
@@ -915,6 +1191,422 @@ void TestScheme::testBootstrap() {
 	cout << "!!! END TEST BOOTSRTAP ALL !!!" << endl;
 }
 
+bool TestScheme::testPackedCiphertext(long logN, long logq, long precisionBits, long logSlots, long bitsDown) {
+	cout << "!!! START TEST PACKED CIPHERTEXT !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	//-----------------------------------------
+	PackedCiphertext packed1 = scheme.pack(cipher1);
+	PackedCiphertext packed2 = scheme.pack(cipher2);
+	Ciphertext unpacked = scheme.unpack(packed1);
+	bool passed = StringUtils::showcheck(isEqualCipher(unpacked, cipher1, context.N), "unpack of pack equal to cipher");
+
+	Ciphertext cadd = scheme.add(cipher1, cipher2);
+	PackedCiphertext packedAdd = packed1;
+	scheme.addAndEqual(packedAdd, packed2);
+	unpacked = scheme.unpack(packedAdd);
+	passed &= StringUtils::showcheck(isEqualCipher(unpacked, cadd, context.N), "packed add equal to add");
+
+	Ciphertext csub = scheme.sub(cipher1, cipher2);
+	PackedCiphertext packedSub = packed1;
+	scheme.subAndEqual(packedSub, packed2);
+	unpacked = scheme.unpack(packedSub);
+	passed &= StringUtils::showcheck(isEqualCipher(unpacked, csub, context.N), "packed sub equal to sub");
+
+	long modes[2] = {RESCALE_TRUNCATE, RESCALE_ROUND};
+	string names[2] = {"truncating", "rounding"};
+	for (long k = 0; k < 2; ++k) {
+		scheme.rescaleMode = modes[k];
+		Ciphertext cres = scheme.reScaleBy(cadd, bitsDown);
+		PackedCiphertext packedRes = packedAdd;
+		scheme.reScaleByAndEqual(packedRes, bitsDown);
+		unpacked = scheme.unpack(packedRes);
+		passed &= StringUtils::showcheck(isEqualCipher(unpacked, cres, context.N), "packed " + names[k] + " rescale by " + to_string(bitsDown) + " bits equal to rescale");
+	}
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	cout << "!!! END TEST PACKED CIPHERTEXT !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testLinearTransformFactored(long logN, long logq, long precisionBits, long logSlots, long levels) {
+	cout << "!!! START TEST LINEAR TRANSFORM FACTORED !!!" << endl;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long size = logSlots == logN - 1 ? slots : slots * 2;
+	long lkey = log2(size);
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, precisionBits);
+	Scheme schemeFactored(secretKey, context);
+	schemeFactored.addConjKey(secretKey);
+	schemeFactored.addBootKeys(secretKey, lkey, precisionBits, levels);
+	//-----------------------------------------
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	//-----------------------------------------
+	Ciphertext cdense = scheme.linearTransform(cipher, size);
+	Ciphertext cconj = scheme.conjugate(cdense);
+	scheme.addAndEqual(cdense, cconj);
+	scheme.reScaleByAndEqual(cdense, precisionBits);
+	scheme.linearTransformInvAndEqual(cdense, size);
+	scheme.reScaleByAndEqual(cdense, precisionBits);
+
+	Ciphertext cfactored = schemeFactored.linearTransformFactored(cipher, size);
+	Ciphertext cconjFactored = schemeFactored.conjugate(cfactored);
+	schemeFactored.addAndEqual(cfactored, cconjFactored);
+	schemeFactored.reScaleByAndEqual(cfactored, precisionBits);
+	schemeFactored.linearTransformInvFactoredAndEqual(cfactored, size);
+	schemeFactored.reScaleByAndEqual(cfactored, precisionBits);
+	//-----------------------------------------
+	CZZ* dvec = scheme.decrypt(secretKey, cdense);
+	CZZ* dvecFactored = scheme.decrypt(secretKey, cfactored);
+	long magBits = 0;
+	for (long i = 0; i < slots; ++i) {
+		magBits = max(magBits, max(NumBits(dvec[i].r), NumBits(dvec[i].i)));
+	}
+	long diffBits = StringUtils::showerror(dvec, dvecFactored, slots, "factored with " + to_string(levels) + " stages against dense, message bits = " + to_string(magBits));
+	bool passed = StringUtils::showcheck(magBits - diffBits > precisionBits / 2, "factored SlotToCoeff equal to dense");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] dvec;
+	delete[] dvecFactored;
+	cout << "!!! END TEST LINEAR TRANSFORM FACTORED !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testBootKeyCompact(long logN, long logq, long logq0, long logT, long logI, long logSlots, long backend) {
+	cout << "!!! START TEST BOOT KEY COMPACT !!!" << endl;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long lkey = logSlots + 1;
+	Params params(logN, logq);
+	Context context(params, backend);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+	//-----------------------------------------
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, logq0 - 6);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq0);
+	Ciphertext cboot = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+
+	Ciphertext cexp = cipher;
+	scheme.modRaiseAndEqual(cexp, logq0, logq, false);
+	for (long i = logSlots; i < logN - 1; ++i) {
+		Ciphertext rot = scheme.leftRotateByPo2(cexp, i);
+		scheme.addAndEqual(cexp, rot);
+	}
+	scheme.reScaleByAndEqual(cexp, logN - 1 - logSlots);
+	linearTransformExpandedAndEqual(scheme, cexp, slots * 2, false);
+	Ciphertext cconj = scheme.conjugate(cexp);
+	scheme.addAndEqual(cexp, cconj);
+	scheme.reScaleByAndEqual(cexp, logq0 + logI + logSlots + 2);
+	scheme.removeIpartAndEqual(cexp, logq0, logT, logI);
+	linearTransformExpandedAndEqual(scheme, cexp, slots * 2, true);
+	scheme.reScaleByAndEqual(cexp, logq0 + logI);
+	bool passed = StringUtils::showcheck(isEqualCipher(cboot, cexp, context.N), "bootstrap with compact diagonals equal to bootstrap with full diagonals");
+
+	CZZ* dvec = scheme.decrypt(secretKey, cboot);
+	StringUtils::showerror(mvec, dvec, slots, "bootstrap with compact diagonals");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] dvec;
+	cout << "!!! END TEST BOOT KEY COMPACT !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testLazyBootKey(long logN, long logq, long logq0, long logT, long logI, long logSlots, long capacity) {
+	cout << "!!! START TEST LAZY BOOT KEY !!!" << endl;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long lkey = logSlots + 1;
+	long size = slots * 2;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+	BootKey eagerKey = scheme.bootKeyMap.at(lkey);
+	//-----------------------------------------
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, logq0 - 6);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq0);
+	Ciphertext cboot = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+
+	scheme.diagonalCache.capacity = capacity;
+	scheme.addLazyBootKeys(secretKey, lkey, logq0 + logI);
+	BootKey& lazyKey = scheme.bootKeyMap.at(lkey);
+	bool passed = true;
+	for (long pass = 0; pass < 2; ++pass) {
+		bool equal = true;
+		ZZX eager, lazy;
+		for (long inv = 0; inv < 2; ++inv) {
+			for (long j = 0; j < size; ++j) {
+				eagerKey.diagonal(context, j, inv)->expand(eager);
+				lazyKey.diagonal(context, j, inv)->expand(lazy);
+				equal &= eager == lazy;
+			}
+		}
+		passed &= StringUtils::showcheck(equal, "lazy diagonals equal to eager ones, pass " + to_string(pass + 1));
+		passed &= StringUtils::showcheck(scheme.diagonalCache.size() <= capacity, "cache keeps at most " + to_string(capacity) + " of " + to_string(2 * size) + " diagonals");
+		Ciphertext cbootLazy = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+		passed &= StringUtils::showcheck(isEqualCipher(cboot, cbootLazy, context.N), "bootstrap with lazy diagonals equal to eager, pass " + to_string(pass + 1));
+	}
+	//-----------------------------------------
+	delete[] mvec;
+	cout << "!!! END TEST LAZY BOOT KEY !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testBootKeyThreads(long logN, long logq, long pBits, long logSlots, long levels, long numThreads) {
+	cout << "!!! START TEST BOOT KEY THREADS !!!" << endl;
+	//-----------------------------------------
+	long lkey = logSlots + 1;
+	Params params(logN, logq);
+	Context context(params, BACKEND_RNS);
+	long threads = AvailableThreads();
+	bool passed = true;
+	long levelsList[2] = {0, levels};
+	for (long k = 0; k < 2; ++k) {
+		SetNumThreads(1);
+		BootKey bootKey(context, pBits, lkey, levelsList[k]);
+		SetNumThreads(numThreads);
+		BootKey bootKeyThreads(context, pBits, lkey, levelsList[k]);
+		passed &= StringUtils::showcheck(isEqualBootKey(bootKey, bootKeyThreads), "BootKey with " + to_string(levelsList[k]) + " levels built with "
+				+ to_string(numThreads) + " threads equal to 1 thread");
+	}
+	SetNumThreads(threads);
+	//-----------------------------------------
+	cout << "!!! END TEST BOOT KEY THREADS !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testSeededKeys(long logN, long logq, long precisionBits, long logSlots, long dnum) {
+	cout << "!!! START TEST SEEDED KEYS !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params, BACKEND_RNS);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context, dnum);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKey(secretKey, 1);
+	map<long, Key> keys = scheme.keyMap;
+	map<long, Key> rotKeys = scheme.leftRotKeyMap;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	Ciphertext cmult = scheme.mult(cipher1, cipher2);
+	Ciphertext cconj = scheme.conjugate(cipher1);
+	Ciphertext crot = scheme.leftRotateFast(cipher1, 1);
+	//-----------------------------------------
+	scheme.compressKeys();
+	bool compressed = true;
+	for (map<long, Key>::iterator it = scheme.keyMap.begin(); it != scheme.keyMap.end(); ++it) {
+		compressed &= it->second.isCompressed();
+	}
+	for (map<long, Key>::iterator it = scheme.leftRotKeyMap.begin(); it != scheme.leftRotKeyMap.end(); ++it) {
+		compressed &= it->second.isCompressed();
+	}
+	bool passed = StringUtils::showcheck(compressed, "all keys are compressed to seeds");
+
+	scheme.expandKeys();
+	passed &= StringUtils::showcheck(isEqualKeys(keys, scheme.keyMap) && isEqualKeys(rotKeys, scheme.leftRotKeyMap), "expanded keys equal to generated keys");
+
+	Ciphertext cmultExp = scheme.mult(cipher1, cipher2);
+	Ciphertext cconjExp = scheme.conjugate(cipher1);
+	Ciphertext crotExp = scheme.leftRotateFast(cipher1, 1);
+	passed &= StringUtils::showcheck(isEqualCipher(cmult, cmultExp, context.N) && isEqualCipher(cconj, cconjExp, context.N)
+			&& isEqualCipher(crot, crotExp, context.N), "mult, conjugate and leftRotateFast with expanded keys equal to generated keys");
+
+	Ciphertext cipher = scheme.encrypt(mvec1, slots, logq);
+	CZZ* dvec = scheme.decrypt(secretKey, cipher);
+	long errBits = StringUtils::showerror(mvec1, dvec, slots, "encrypt with expanded key");
+	passed &= StringUtils::showcheck(errBits < precisionBits / 2, "encrypt with expanded key decrypts to message");
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	delete[] dvec;
+	cout << "!!! END TEST SEEDED KEYS !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testBootstrapParallel(long logN, long logq, long logq0, long logT, long logI, long logSlots, long numThreads) {
+	cout << "!!! START TEST BOOTSTRAP PARALLEL !!!" << endl;
+	//-----------------------------------------
+	bool passed = true;
+	long outer = 4;
+	long inner = 8;
+	long threadsList[2] = {0, numThreads};
+	for (long t = 0; t < 2; ++t) {
+		TaskScheduler scheduler(threadsList[t]);
+		atomic<long> count(0);
+		TaskGroup group;
+		for (long i = 0; i < outer; ++i) {
+			scheduler.spawn(group, [&scheduler, &count, inner]() {
+				TaskGroup nested;
+				for (long j = 0; j < inner; ++j) {
+					scheduler.spawn(nested, [&count]() { count++; });
+				}
+				scheduler.wait(nested);
+			});
+		}
+		scheduler.wait(group);
+		passed &= StringUtils::showcheck(count == outer * inner, "nested spawn and wait with " + to_string(threadsList[t]) + " threads");
+	}
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long lkey = logSlots == logN - 1 ? logSlots : logSlots + 1;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+	//-----------------------------------------
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, logq0 - 6);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq0);
+	Ciphertext cboot = cipher;
+	scheme.bootstrapAndEqual(cboot, logq0, logq, logT, logI);
+	TaskScheduler scheduler(numThreads);
+	Ciphertext cbootPar = cipher;
+	scheme.bootstrapParallelAndEqual(cbootPar, scheduler, logq0, logq, logT, logI);
+	passed &= StringUtils::showcheck(cboot.cbits == cbootPar.cbits && isEqualCipher(cboot, cbootPar, context.N), "bootstrapParallel equal to bootstrap");
+
+	CZZ* dvec = scheme.decrypt(secretKey, cbootPar);
+	StringUtils::showerror(mvec, dvec, slots, "bootstrapParallel");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] dvec;
+	cout << "!!! END TEST BOOTSTRAP PARALLEL !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testSparseBootstrap(long logN, long logq, long logq0, long logT, long logI, long sparseh, long logSlots) {
+	cout << "!!! START TEST SPARSE BOOTSTRAP !!!" << endl;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long lkey = logSlots == logN - 1 ? logSlots : logSlots + 1;
+	long logIsparse = Scheme::sparseLogI(sparseh);
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+	Scheme schemeSparse(secretKey, context);
+	schemeSparse.addConjKey(secretKey);
+	schemeSparse.addLeftRotKeys(secretKey);
+	schemeSparse.addBootKeys(secretKey, lkey, logq0 + logIsparse, 0, sparseh);
+	//-----------------------------------------
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, logq0 - 6);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq0);
+
+	bool thrown = false;
+	try {
+		scheme.bootstrap(cipher, logq0, logq, logT, logI, true);
+	} catch (invalid_argument& e) {
+		thrown = true;
+	}
+	bool passed = StringUtils::showcheck(thrown, "sparse bootstrap without sparse keys is rejected");
+
+	Ciphertext cboot = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+	scheme.addSparseKeys(secretKey, sparseh);
+	Ciphertext cbootKeys = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+	passed &= StringUtils::showcheck(isEqualCipher(cboot, cbootKeys, context.N), "sparse keys are not used unless sparse is set");
+
+	Ciphertext cbootSparse = schemeSparse.bootstrap(cipher, logq0, logq, logT, logIsparse, true);
+	CZZ* dvec = scheme.decrypt(secretKey, cboot);
+	CZZ* dvecSparse = scheme.decrypt(secretKey, cbootSparse);
+	long errBits = StringUtils::showerror(mvec, dvec, slots, "bootstrap, logI = " + to_string(logI));
+	long errBitsSparse = StringUtils::showerror(mvec, dvecSparse, slots, "sparse bootstrap, logI = " + to_string(logIsparse));
+	cout << "remaining cbits = " << cboot.cbits << ", sparse = " << cbootSparse.cbits << endl;
+	passed &= StringUtils::showcheck(cbootSparse.cbits > cboot.cbits, "sparse bootstrap keeps more modulus");
+	passed &= StringUtils::showcheck(errBitsSparse <= errBits + 2, "sparse bootstrap keeps precision");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] dvec;
+	delete[] dvecSparse;
+	cout << "!!! END TEST SPARSE BOOTSTRAP !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testEvalModPlan(long logN, long logq, long logq0, long logT, long logI, long precisionBits, long logSlots) {
+	cout << "!!! START TEST EVAL MOD PLAN !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addEvalModPlan(logI, logT, precisionBits);
+	EvalModPlan& plan = scheme.evalModPlanMap.at(logI);
+	cout << "plan: doubleAngles = " << plan.doubleAngles << ", degree = " << plan.degree << ", depth = " << plan.depth << ", mults = " << plan.mults
+			<< ", estimated error bits = " << plan.errorBits << endl;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	long double q0 = ldexpl(1.0L, logq0);
+	long double pi = acosl(-1.0L);
+	CZZ* mvec = new CZZ[slots];
+	long double* expected = new long double[slots];
+	for (long i = 0; i < slots; ++i) {
+		ZZ m = RandomBits_ZZ(logq0 - 1) - power2_ZZ(logq0 - 2);
+		long I = RandomBnd(2 * (1L << logI) - 1) - (1L << logI) + 1;
+		mvec[i].r = m + I * power2_ZZ(logq0);
+		expected[i] = q0 / (2 * pi) * sinl(2 * pi * EvaluatorUtils::evalLongDouble(m) / q0);
+	}
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq, false);
+	//-----------------------------------------
+	Ciphertext cres = scheme.removeIpart(cipher, logq0, logT, logI);
+	Ciphertext cresEqual = cipher;
+	scheme.removeIpartAndEqual(cresEqual, logq0, logT, logI);
+	bool passed = StringUtils::showcheck(isEqualCipher(cres, cresEqual, context.N), "removeIpart equal to removeIpartAndEqual");
+
+	CZZ* dvec = scheme.decrypt(secretKey, cres);
+	long double maxErr = 0;
+	for (long i = 0; i < slots; ++i) {
+		maxErr = max(maxErr, fabsl(EvaluatorUtils::evalLongDouble(dvec[i].r) - expected[i]));
+	}
+	double errBits = log2((double) (maxErr * 2 * pi / q0));
+	cout << "measured error bits of sin = " << errBits << ", estimated = " << plan.errorBits << endl;
+	passed &= StringUtils::showcheck(errBits <= plan.errorBits + 1, "removeIpart error within estimate of plan");
+	passed &= StringUtils::showcheck(plan.mults < plan.degree - 1 + plan.doubleAngles, "plan needs fewer key switches than power basis");
+
+	bool thrown = false;
+	try {
+		scheme.removeIpart(cipher, logq0, logT + 1, logI);
+	} catch (invalid_argument& e) {
+		thrown = true;
+	}
+	passed &= StringUtils::showcheck(thrown, "plan of another logT is rejected");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] expected;
+	delete[] dvec;
+	cout << "!!! END TEST EVAL MOD PLAN !!!" << endl;
+	return passed;
+}
+
 void TestScheme::testBootstrapOneReal() {
 	cout << "!!! START TEST BOOTSTRAP ONE REAL !!!" << endl;
 	long logq = 620;
@@ -973,6 +1665,671 @@ void TestScheme::testBootstrapOneReal() {
 	cout << "!!! END TEST BOOTSRTAP ONE REAL !!!" << endl;
 }
 
+bool TestScheme::testSerialization(long logN, long logq, long logSlots) {
+	cout << "!!! START TEST SERIALIZATION !!!" << endl;
+	long nu = 6;
+	long msgBits = 25;
+	long logq0 = msgBits + nu;
+	long logT = 2;
+	long logI = 4;
+	long slots = (1 << logSlots);
+	long lkey = logSlots == logN - 1 ? logSlots : logSlots + 1;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, msgBits);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq0);
+	//-----------------------------------------
+	stringstream stream;
+	timeutils.start("Write");
+	SerializationUtils::writeParams(stream, context);
+	SerializationUtils::writeKeys(stream, scheme);
+	SerializationUtils::writeCiphertext(stream, cipher);
+	timeutils.stop("Write");
+	cout << "bytes written = " << stream.str().size() << endl;
+	//-----------------------------------------
+	timeutils.start("Read");
+	long backend;
+	Params paramsRead = SerializationUtils::readParams(stream, backend);
+	Context contextRead(paramsRead, backend);
+	SecretKey secretKeyOther(paramsRead);
+	Scheme schemeRead(secretKeyOther, contextRead);
+	SerializationUtils::readKeys(stream, schemeRead);
+	Ciphertext cipherRead = SerializationUtils::readCiphertext(stream);
+	timeutils.stop("Read");
+	//-----------------------------------------
+	bool passed = StringUtils::showcheck(paramsRead.logN == logN && paramsRead.logq == logq && backend == context.backend, "params read back");
+	passed &= StringUtils::showcheck(isEqualKeys(scheme.keyMap, schemeRead.keyMap) && isEqualKeys(scheme.leftRotKeyMap, schemeRead.leftRotKeyMap), "keys read back");
+	passed &= StringUtils::showcheck(cipherRead.slots == cipher.slots && isEqualCipher(cipher, cipherRead, context.N), "ciphertext read back");
+
+	Ciphertext cboot = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+	schemeRead.bootstrapAndEqual(cipherRead, logq0, logq, logT, logI);
+	passed &= StringUtils::showcheck(isEqualCipher(cboot, cipherRead, context.N), "bootstrap with read keys equal to bootstrap with written keys");
+	CZZ* dvec = schemeRead.decrypt(secretKey, cipherRead);
+	StringUtils::showerror(mvec, dvec, slots, "bootstrap with read keys");
+	//-----------------------------------------
+	stringstream corrupted;
+	SerializationUtils::writeCiphertext(corrupted, cipher);
+	string bytes = corrupted.str();
+	bytes[bytes.size() / 2] ^= 1;
+	corrupted.str(bytes);
+	bool thrown = false;
+	try {
+		SerializationUtils::readCiphertext(corrupted);
+	} catch (runtime_error& e) {
+		cout << "corrupted ciphertext: " << e.what() << endl;
+		thrown = true;
+	}
+	passed &= StringUtils::showcheck(thrown, "corrupted ciphertext is detected");
+	delete[] mvec;
+	delete[] dvec;
+	cout << "!!! END TEST SERIALIZATION !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testKeyStore(long logN, long logq, long logSlots) {
+	cout << "!!! START TEST KEY STORE !!!" << endl;
+	long nu = 6;
+	long msgBits = 25;
+	long logq0 = msgBits + nu;
+	long logT = 2;
+	long logI = 4;
+	long slots = (1 << logSlots);
+	long lkey = logSlots == logN - 1 ? logSlots : logSlots + 1;
+	string path = "TestScheme.keys";
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params, BACKEND_RNS);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKeys(secretKey);
+	scheme.addBootKeys(secretKey, lkey, logq0 + logI);
+	//-----------------------------------------
+	timeutils.start("Write key store");
+	KeyStore::write(path, scheme);
+	timeutils.stop("Write key store");
+
+	SecretKey secretKeyOther(params);
+	Scheme schemeLoaded(secretKeyOther, context);
+	bool passed = true;
+	{
+		timeutils.start("Load key store");
+		KeyStore store(path, context);
+		store.load(schemeLoaded);
+		timeutils.stop("Load key store");
+		cout << "bytes mapped = " << store.size << endl;
+		passed &= StringUtils::showcheck(schemeLoaded.keyMap.size() == scheme.keyMap.size() && schemeLoaded.leftRotKeyMap.size() == scheme.leftRotKeyMap.size()
+				&& schemeLoaded.bootKeyMap.size() == scheme.bootKeyMap.size(), "all keys loaded");
+		//-----------------------------------------
+		CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, msgBits);
+		CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, msgBits);
+		Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+		Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+		Ciphertext cmult = scheme.mult(cipher1, cipher2);
+		Ciphertext cmultLoaded = schemeLoaded.mult(cipher1, cipher2);
+		passed &= StringUtils::showcheck(isEqualCipher(cmult, cmultLoaded, context.N), "mult with loaded keys equal to mult with written keys");
+		Ciphertext cconj = scheme.conjugate(cipher1);
+		Ciphertext cconjLoaded = schemeLoaded.conjugate(cipher1);
+		passed &= StringUtils::showcheck(isEqualCipher(cconj, cconjLoaded, context.N), "conjugate with loaded keys equal to conjugate with written keys");
+		Ciphertext crot = scheme.leftRotateFast(cipher1, 1);
+		Ciphertext crotLoaded = schemeLoaded.leftRotateFast(cipher1, 1);
+		passed &= StringUtils::showcheck(isEqualCipher(crot, crotLoaded, context.N), "leftRotateFast with loaded keys equal to leftRotateFast with written keys");
+
+		Ciphertext cipher = scheme.encrypt(mvec1, slots, logq0);
+		Ciphertext cboot = scheme.bootstrap(cipher, logq0, logq, logT, logI);
+		Ciphertext cbootLoaded = schemeLoaded.bootstrap(cipher, logq0, logq, logT, logI);
+		passed &= StringUtils::showcheck(isEqualCipher(cboot, cbootLoaded, context.N), "bootstrap with loaded keys equal to bootstrap with written keys");
+		delete[] mvec1;
+		delete[] mvec2;
+	}
+	//-----------------------------------------
+	Params paramsOther(logN, logq + 1);
+	Context contextOther(paramsOther, BACKEND_RNS);
+	bool thrown = false;
+	try {
+		KeyStore store(path, contextOther);
+	} catch (runtime_error& e) {
+		cout << "store of another context: " << e.what() << endl;
+		thrown = true;
+	}
+	passed &= StringUtils::showcheck(thrown, "store of another context is rejected");
+	remove(path.c_str());
+	cout << "!!! END TEST KEY STORE !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testMultKeyCopy(long logN, long logq, long precisionBits, long logSlots, long iters) {
+	cout << "!!! START TEST MULT KEY COPY !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	scheme.addConjKey(secretKey);
+	scheme.addLeftRotKey(secretKey, 1);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	//-----------------------------------------
+	string names[4] = {"mult", "square", "conjugate", "leftRotateFast"};
+	Key* keys[4] = {&scheme.keyMap.at(MULTIPLICATION), &scheme.keyMap.at(MULTIPLICATION),
+			&scheme.keyMap.at(CONJUGATION), &scheme.leftRotKeyMap.at(1)};
+	function<void()> ops[4] = {
+			[&]() { Ciphertext res = scheme.mult(cipher1, cipher2); },
+			[&]() { Ciphertext res = scheme.square(cipher1); },
+			[&]() { Ciphertext res = scheme.conjugate(cipher1); },
+			[&]() { Ciphertext res = scheme.leftRotateFast(cipher1, 1); }
+	};
+	bool passed = true;
+	for (long k = 0; k < 4; ++k) {
+		timeutils.start(names[k] + " with key by reference");
+		for (long i = 0; i < iters; ++i) {
+			ops[k]();
+		}
+		timeutils.stop(names[k] + " with key by reference");
+		double timeRef = timeutils.timeElapsed;
+		timeutils.start(names[k] + " with copy of key as before");
+		for (long i = 0; i < iters; ++i) {
+			Key key = *keys[k];
+			ops[k]();
+		}
+		timeutils.stop(names[k] + " with copy of key as before");
+		cout << names[k] << ": copy of key as before costs " << timeutils.timeElapsed - timeRef << " ms in " << iters << " calls" << endl;
+
+		Key key = *keys[k];
+		Ciphertext cipherRef = cipher1;
+		Ciphertext cipherCopy = cipher1;
+		scheme.switchKeyAndEqual(cipherRef, *keys[k]);
+		scheme.switchKeyAndEqual(cipherCopy, key);
+		passed &= StringUtils::showcheck(isEqualCipher(cipherRef, cipherCopy, context.N), names[k] + " key switching by reference equal to switching with copy of key");
+	}
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	cout << "!!! END TEST MULT KEY COPY !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testHybridKeySwitching(long logN, long logq, long precisionBits, long logDegree, long logSlots, long dnum) {
+	cout << "!!! START TEST HYBRID KEY SWITCHING !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context, dnum);
+	scheme.addLeftRotKey(secretKey, 1);
+	SchemeAlgo algo(scheme);
+	Scheme schemeStandard(secretKey, context);
+	schemeStandard.addLeftRotKey(secretKey, 1);
+	SchemeAlgo algoStandard(schemeStandard);
+	//-----------------------------------------
+	long slots = 1 << logSlots;
+	CZZ* mvec = new CZZ[slots];
+	CZZ* mpow = new CZZ[slots];
+	CZZ* mrot = new CZZ[slots];
+	for (long i = 0; i < slots; ++i) {
+		RR angle = random_RR();
+		RR mr = cos(angle * 2 * Pi);
+		RR mi = sin(angle * 2 * Pi);
+		mvec[i] = EvaluatorUtils::evalCZZ(mr, mi, precisionBits);
+		mpow[i] = EvaluatorUtils::evalCZZPow2(mr, mi, logDegree, precisionBits);
+	}
+	for (long i = 0; i < slots; ++i) {
+		mrot[i] = mvec[(i + 1) % slots];
+	}
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	//-----------------------------------------
+	timeutils.start("Power of 2 batch with standard keys");
+	Ciphertext cpowStandard = algoStandard.powerOf2(cipher, precisionBits, logDegree);
+	timeutils.stop("Power of 2 batch with standard keys");
+
+	timeutils.start("Power of 2 batch with hybrid keys");
+	Ciphertext cpow = algo.powerOf2(cipher, precisionBits, logDegree);
+	timeutils.stop("Power of 2 batch with hybrid keys");
+
+	timeutils.start("Left rotate by 1 with standard keys");
+	Ciphertext crotStandard = schemeStandard.leftRotateFast(cipher, 1);
+	timeutils.stop("Left rotate by 1 with standard keys");
+
+	timeutils.start("Left rotate by 1 with hybrid keys");
+	Ciphertext crot = scheme.leftRotateFast(cipher, 1);
+	timeutils.stop("Left rotate by 1 with hybrid keys");
+	//-----------------------------------------
+	CZZ* dpowStandard = scheme.decrypt(secretKey, cpowStandard);
+	CZZ* dpow = scheme.decrypt(secretKey, cpow);
+	StringUtils::showerror(mpow, dpowStandard, slots, "pow with standard keys");
+	StringUtils::showerror(mpow, dpow, slots, "pow with hybrid keys");
+	long powBits = StringUtils::showerror(dpowStandard, dpow, slots, "pow with hybrid keys against standard keys");
+	bool passed = StringUtils::showcheck(powBits < precisionBits / 2, "pow with hybrid keys agrees with standard keys in upper half of precision bits");
+
+	CZZ* drotStandard = scheme.decrypt(secretKey, crotStandard);
+	CZZ* drot = scheme.decrypt(secretKey, crot);
+	StringUtils::showerror(mrot, drotStandard, slots, "rot with standard keys");
+	StringUtils::showerror(mrot, drot, slots, "rot with hybrid keys");
+	long rotBits = StringUtils::showerror(drotStandard, drot, slots, "rot with hybrid keys against standard keys");
+	passed &= StringUtils::showcheck(rotBits < precisionBits / 2, "rot with hybrid keys agrees with standard keys in upper half of precision bits");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] mpow;
+	delete[] mrot;
+	delete[] dpowStandard;
+	delete[] dpow;
+	delete[] drotStandard;
+	delete[] drot;
+	cout << "!!! END TEST HYBRID KEY SWITCHING !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testLevelKeys(long logN, long logq, long precisionBits, long logDegree, long logSlots) {
+	cout << "!!! START TEST LEVEL KEYS !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	SchemeAlgo algo(scheme);
+	//-----------------------------------------
+	long slots = 1 << logSlots;
+	CZZ* mvec = new CZZ[slots];
+	CZZ* mpow = new CZZ[slots];
+	for (long i = 0; i < slots; ++i) {
+		RR angle = random_RR();
+		RR mr = cos(angle * 2 * Pi);
+		RR mi = sin(angle * 2 * Pi);
+		mvec[i] = EvaluatorUtils::evalCZZ(mr, mi, precisionBits);
+		mpow[i] = EvaluatorUtils::evalCZZPow2(mr, mi, logDegree, precisionBits);
+	}
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	//-----------------------------------------
+	timeutils.start("Power of 2 batch with full keys");
+	Ciphertext cpow = algo.powerOf2(cipher, precisionBits, logDegree);
+	timeutils.stop("Power of 2 batch with full keys");
+
+	scheme.useLevelKeys = true;
+	timeutils.start("Power of 2 batch building level keys");
+	Ciphertext cpowLevel = algo.powerOf2(cipher, precisionBits, logDegree);
+	timeutils.stop("Power of 2 batch building level keys");
+
+	timeutils.start("Power of 2 batch with level keys");
+	cpowLevel = algo.powerOf2(cipher, precisionBits, logDegree);
+	timeutils.stop("Power of 2 batch with level keys");
+	long levels = scheme.keyMap.at(MULTIPLICATION).levels->size();
+	cout << "level keys = " << levels << endl;
+	//-----------------------------------------
+	bool passed = StringUtils::showcheck(levels > 0, "level keys are built");
+	passed &= StringUtils::showcheck(isEqualCipher(cpow, cpowLevel, context.N), "power of 2 with level keys equal to power of 2 with full keys");
+	CZZ* dpow = scheme.decrypt(secretKey, cpow);
+	StringUtils::showerror(mpow, dpow, slots, "pow");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] mpow;
+	delete[] dpow;
+	cout << "!!! END TEST LEVEL KEYS !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testInnerProd(long logN, long logq, long precisionBits, long logSlots, long size) {
+	cout << "!!! START TEST INNER PRODUCT !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	SchemeAlgo algo(scheme);
+	//-----------------------------------------
+	long slots = 1 << logSlots;
+	CZZ* mprod = new CZZ[slots];
+	Ciphertext* ciphers1 = new Ciphertext[size];
+	Ciphertext* ciphers2 = new Ciphertext[size];
+	for (long i = 0; i < size; ++i) {
+		CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+		CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+		for (long j = 0; j < slots; ++j) {
+			mprod[j] += (mvec1[j] * mvec2[j]) >> precisionBits;
+		}
+		ciphers1[i] = scheme.encrypt(mvec1, slots, logq);
+		ciphers2[i] = scheme.encrypt(mvec2, slots, logq);
+		delete[] mvec1;
+		delete[] mvec2;
+	}
+	//-----------------------------------------
+	timeutils.start("Inner product with one linearization");
+	Ciphertext cprod = algo.innerProd(ciphers1, ciphers2, precisionBits, size);
+	timeutils.stop("Inner product with one linearization");
+
+	timeutils.start("Inner product with linearization of each product");
+	Ciphertext cprodEach = scheme.mult(ciphers1[0], ciphers2[0]);
+	for (long i = 1; i < size; ++i) {
+		Ciphertext cmult = scheme.mult(ciphers1[i], ciphers2[i]);
+		scheme.addAndEqual(cprodEach, cmult);
+	}
+	scheme.reScaleByAndEqual(cprodEach, precisionBits);
+	timeutils.stop("Inner product with linearization of each product");
+	//-----------------------------------------
+	CZZ* dprod = scheme.decrypt(secretKey, cprod);
+	CZZ* dprodEach = scheme.decrypt(secretKey, cprodEach);
+	StringUtils::showerror(mprod, dprod, slots, "inner product");
+	StringUtils::showerror(mprod, dprodEach, slots, "inner product with linearization of each product");
+	long prodBits = StringUtils::showerror(dprodEach, dprod, slots, "inner product against linearization of each product");
+	bool passed = StringUtils::showcheck(cprod.cbits == cprodEach.cbits && prodBits < precisionBits / 2,
+			"inner product agrees with linearization of each product in upper half of precision bits");
+	//-----------------------------------------
+	delete[] mprod;
+	delete[] ciphers1;
+	delete[] ciphers2;
+	delete[] dprod;
+	delete[] dprodEach;
+	cout << "!!! END TEST INNER PRODUCT !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testFusedMult(long logN, long logq, long precisionBits, long logSlots, long iters) {
+	cout << "!!! START TEST FUSED MULT !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	ZZ cnst = EvaluatorUtils::evalZZ(0.5, precisionBits);
+	Ciphertext cmult, cfused, cacc, caccFused, cconst, cconstFused;
+	//-----------------------------------------
+	timeutils.start("Multiplication and rescaling");
+	for (long i = 0; i < iters; ++i) {
+		cmult = scheme.mult(cipher1, cipher2);
+		scheme.reScaleByAndEqual(cmult, precisionBits);
+	}
+	timeutils.stop("Multiplication and rescaling");
+
+	timeutils.start("Fused multiplication and rescaling");
+	for (long i = 0; i < iters; ++i) {
+		cfused = scheme.multAndRescale(cipher1, cipher2, precisionBits);
+	}
+	timeutils.stop("Fused multiplication and rescaling");
+	//-----------------------------------------
+	cacc = cipher1;
+	timeutils.start("Multiplication and addition");
+	for (long i = 0; i < iters; ++i) {
+		Ciphertext cprod = scheme.mult(cipher1, cipher2);
+		scheme.addAndEqual(cacc, cprod);
+	}
+	timeutils.stop("Multiplication and addition");
+
+	caccFused = cipher1;
+	timeutils.start("Multiply-accumulate");
+	for (long i = 0; i < iters; ++i) {
+		scheme.multAcc(caccFused, cipher1, cipher2);
+	}
+	timeutils.stop("Multiply-accumulate");
+	//-----------------------------------------
+	timeutils.start("Constant multiplication and rescaling");
+	for (long i = 0; i < iters; ++i) {
+		cconst = scheme.multByConst(cipher1, cnst);
+		scheme.reScaleByAndEqual(cconst, precisionBits);
+	}
+	timeutils.stop("Constant multiplication and rescaling");
+
+	timeutils.start("Fused constant multiplication and rescaling");
+	for (long i = 0; i < iters; ++i) {
+		cconstFused = scheme.multByConstAndRescale(cipher1, cnst, precisionBits);
+	}
+	timeutils.stop("Fused constant multiplication and rescaling");
+	//-----------------------------------------
+	bool passed = StringUtils::showcheck(cmult.cbits == cfused.cbits && isEqualCipher(cmult, cfused, context.N), "multAndRescale equal to mult and reScaleBy");
+	passed &= StringUtils::showcheck(isEqualCipher(cacc, caccFused, context.N), "multAcc equal to mult and add");
+	passed &= StringUtils::showcheck(cconst.cbits == cconstFused.cbits && isEqualCipher(cconst, cconstFused, context.N), "multByConstAndRescale equal to multByConst and reScaleBy");
+
+	bool thrown = false;
+	try {
+		scheme.multAcc(cfused, cipher1, cipher2);
+	} catch (invalid_argument& e) {
+		thrown = true;
+	}
+	passed &= StringUtils::showcheck(thrown, "multAcc to accumulator at another level is rejected");
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	cout << "!!! END TEST FUSED MULT !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testAutomorphism(long logN, long logq, long logSlots, long iters) {
+	cout << "!!! START TEST AUTOMORPHISM !!!" << endl;
+	//-----------------------------------------
+	TimeUtils timeutils;
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	RingMultiplier multiplier(logN, logq);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec = EvaluatorUtils::evalRandCZZArray(slots, logq / 2);
+	Ciphertext cipher = scheme.encrypt(mvec, slots, logq);
+	ZZX res, resNTT;
+	long np = multiplier.numPrimes(logq + 1);
+	uint64_t* ra = new uint64_t[np << logN];
+	uint64_t* rres = new uint64_t[np << logN];
+	multiplier.toNTT(ra, cipher.ax, np);
+	//-----------------------------------------
+	timeutils.start("Automorphisms from power");
+	for (long i = 0; i < iters; ++i) {
+		for (long rot = 1; rot < context.N / 2; rot <<= 1) {
+			Ring2Utils::inpower(res, cipher.ax, context.rotGroup[rot], context.q, context.N);
+		}
+	}
+	timeutils.stop("Automorphisms from power");
+
+	timeutils.start("Automorphisms in NTT form from tables");
+	for (long i = 0; i < iters; ++i) {
+		for (long rot = 1; rot < context.N / 2; rot <<= 1) {
+			multiplier.automorphism(rres, ra, context.automorphism(context.rotGroup[rot]), np);
+		}
+	}
+	timeutils.stop("Automorphisms in NTT form from tables");
+	//-----------------------------------------
+	bool sameNTT = true;
+	for (long rot = 1; rot < context.N / 2; rot <<= 1) {
+		Ring2Utils::inpower(res, cipher.ax, context.rotGroup[rot], context.q, context.N);
+		multiplier.automorphism(rres, ra, context.automorphism(context.rotGroup[rot]), np);
+		multiplier.reconstruct(resNTT, rres, np, context.q);
+		for (long i = 0; i < context.N; ++i) {
+			sameNTT = sameNTT && rem(coeff(res, i) - coeff(resNTT, i), context.q) == 0;
+		}
+	}
+	bool passed = StringUtils::showcheck(sameNTT, "automorphisms in NTT form equal automorphisms from power modulo q");
+	//-----------------------------------------
+	delete[] mvec;
+	delete[] ra;
+	delete[] rres;
+	cout << "!!! END TEST AUTOMORPHISM !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testMultThreads(long logN, long logq, long precisionBits, long logSlots, long numThreads) {
+	cout << "!!! START TEST MULT THREADS !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	long threads = AvailableThreads();
+	//-----------------------------------------
+	SetNumThreads(1);
+	Ciphertext cmult = scheme.mult(cipher1, cipher2);
+	Ciphertext csquare = scheme.square(cipher1);
+
+	SetNumThreads(numThreads);
+	Ciphertext cmultPar = scheme.mult(cipher1, cipher2);
+	bool passed = StringUtils::showcheck(isEqualCipher(cmult, cmultPar, context.N), "mult with " + to_string(numThreads) + " threads equal to mult with 1 thread");
+
+	bool nested = true;
+	NTL_EXEC_RANGE(numThreads, first, last);
+	for (long i = first; i < last; ++i) {
+		Ciphertext cmultNested = scheme.mult(cipher1, cipher2);
+		Ciphertext csquareNested = scheme.square(cipher1);
+		if(!isEqualCipher(cmult, cmultNested, context.N) || !isEqualCipher(csquare, csquareNested, context.N)) nested = false;
+	}
+	NTL_EXEC_RANGE_END;
+	passed &= StringUtils::showcheck(nested, "mult and square inside NTL_EXEC_RANGE equal to mult and square with 1 thread");
+
+	TaskScheduler scheduler(2);
+	TaskGroup group;
+	bool worker = true;
+	scheduler.spawn(group, [&]() {
+		Ciphertext cmultWorker = scheme.mult(cipher1, cipher2);
+		worker = isEqualCipher(cmult, cmultWorker, context.N);
+	});
+	scheduler.wait(group);
+	passed &= StringUtils::showcheck(worker, "mult in TaskScheduler task equal to mult with 1 thread");
+	SetNumThreads(threads);
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	cout << "!!! END TEST MULT THREADS !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testRNSMult(long logN, long logq, long precisionBits, long logSlots) {
+	cout << "!!! START TEST RNS MULT !!!" << endl;
+	//-----------------------------------------
+	Params params(logN, logq);
+	Context context(params, BACKEND_RNS);
+	Context contextZZX(params);
+	SecretKey secretKey(params);
+	Scheme scheme(secretKey, context);
+	Scheme schemeZZX(secretKey, contextZZX);
+	schemeZZX.keyMap = scheme.keyMap;
+	//-----------------------------------------
+	long slots = (1 << logSlots);
+	CZZ* mvec1 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	CZZ* mvec2 = EvaluatorUtils::evalRandCZZArray(slots, precisionBits);
+	ZZ cnst = RandomBits_ZZ(precisionBits);
+	Ciphertext cipher1 = scheme.encrypt(mvec1, slots, logq);
+	Ciphertext cipher2 = scheme.encrypt(mvec2, slots, logq);
+	//-----------------------------------------
+	bool passed = true;
+	long cbitsList[3] = {logq, logq / 2, 2 * precisionBits};
+	for (long i = 0; i < 3; ++i) {
+		Ciphertext c1 = scheme.modDownTo(cipher1, cbitsList[i]);
+		Ciphertext c2 = scheme.modDownTo(cipher2, cbitsList[i]);
+		string level = " at cbits = " + to_string(cbitsList[i]);
+
+		Ciphertext cmult = scheme.mult(c1, c2);
+		Ciphertext cmultZZX = schemeZZX.mult(c1, c2);
+		passed &= StringUtils::showcheck(isEqualCipher(cmult, cmultZZX, context.N), "mult" + level);
+
+		Ciphertext csquare = scheme.square(c1);
+		Ciphertext csquareZZX = schemeZZX.square(c1);
+		passed &= StringUtils::showcheck(isEqualCipher(csquare, csquareZZX, context.N), "square" + level);
+
+		Ciphertext cconst = scheme.multByConst(c1, cnst);
+		Ciphertext cconstZZX = schemeZZX.multByConst(c1, cnst);
+		passed &= StringUtils::showcheck(isEqualCipher(cconst, cconstZZX, context.N), "multByConst" + level);
+	}
+	//-----------------------------------------
+	ZZX p1, p2, res, resZZX;
+	p1.SetLength(context.N);
+	p2.SetLength(context.N);
+	for (long i = 0; i < context.N; ++i) {
+		RandomBits(p1.rep[i], context.logqq);
+		RandomBits(p2.rep[i], context.logqq);
+	}
+	long np = context.multiplier->numPrimes(2 * context.logqq + logN);
+	cout << "primes of product modulo qq: " << np << " of " << context.multiplier->maxnp << endl;
+	passed &= StringUtils::showcheck(np > 0, "product modulo qq fits in primes");
+
+	Ring2Utils::mult(res, p1, p2, context.qq, context.N, context.multiplier);
+	Ring2Utils::mult(resZZX, p1, p2, context.qq, context.N);
+	passed &= StringUtils::showcheck(res == resZZX, "mult of polynomials modulo qq");
+
+	Ring2Utils::square(res, p1, context.qq, context.N, context.multiplier);
+	Ring2Utils::square(resZZX, p1, context.qq, context.N);
+	passed &= StringUtils::showcheck(res == resZZX, "square of polynomial modulo qq");
+	//-----------------------------------------
+	delete[] mvec1;
+	delete[] mvec2;
+	cout << "!!! END TEST RNS MULT !!!" << endl;
+	return passed;
+}
+
+bool TestScheme::testNTTSimd(long logN, long logq) {
+	cout << "!!! START TEST NTT SIMD !!!" << endl;
+	//-----------------------------------------
+	RingMultiplier multiplier(logN, logq);
+	long N = multiplier.N;
+	long supported = RingMultiplier::detectSimd();
+	string names[3] = {"scalar", "avx2", "avx512"};
+	uint64_t* input = new uint64_t[N];
+	uint64_t* ref = new uint64_t[N];
+	uint64_t* a = new uint64_t[N];
+	//-----------------------------------------
+	bool passed = true;
+	for (long simd = SIMD_SCALAR; simd <= SIMD_AVX512; ++simd) {
+		if(simd > supported) {
+			cout << "SKIPPED: " << names[simd] << " is not supported" << endl;
+			continue;
+		}
+		bool same = true;
+		bool inverse = true;
+		for (long index = 0; index < multiplier.maxnp; ++index) {
+			uint64_t p = multiplier.pVec[index];
+			for (long k = 0; k < 2; ++k) {
+				for (long j = 0; j < N; ++j) {
+					input[j] = k == 0 ? RandomBnd((long)p) : p - 1;
+				}
+				multiplier.simd = SIMD_SCALAR;
+				copy(input, input + N, ref);
+				multiplier.NTT(ref, index);
+
+				multiplier.simd = simd;
+				copy(input, input + N, a);
+				multiplier.NTT(a, index);
+				same = same && equal(a, a + N, ref);
+				multiplier.INTT(a, index);
+				inverse = inverse && equal(a, a + N, input);
+			}
+		}
+		passed &= StringUtils::showcheck(same, names[simd] + " NTT equals scalar NTT");
+		passed &= StringUtils::showcheck(inverse, names[simd] + " INTT of NTT equals input");
+	}
+	multiplier.simd = supported;
+	//-----------------------------------------
+	delete[] input;
+	delete[] ref;
+	delete[] a;
+	cout << "!!! END TEST NTT SIMD !!!" << endl;
+	return passed;
+}
+
 void TestScheme::testBoundOfI() {
 	cout << "!!! START TEST BOUND OF I !!!" << endl;
 	long logq = 200;
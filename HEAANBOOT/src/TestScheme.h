@@ -16,6 +16,17 @@ public:
 	 */
 	static void testEncodeBatch(long logN, long logq, long precisionBits, long logSlots);
 
+	/**
+	 * Checking double and long double paths of encoding and decoding against RR:
+	 * encodings of 30-bit values and of FFT_DOUBLE_BITS + 2-bit values differ from RR encoding below the unit of message 2^logq,
+	 * and decodings of these encodings without scale 2^logq differ by at most 1 from their evaluation in RR
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] log of number of slots
+	 * @return true if all differences are within bounds
+	 */
+	static bool testEncodePrecision(long logN, long logq, long logSlots);
+
 	//-----------------------------------------
 
 	/**
@@ -70,6 +81,17 @@ public:
 	 */
 	static void testSlotsSum(long logN, long logq, long precisionBits, long logSlots);
 
+	/**
+	 * Checking partial sums: partialSlotsSum gives the same cipher as partialSlotsSumAndEqual,
+	 * and decrypts to the sums of messages with error below half of precision bits
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @return true if ciphers are equal and error is small
+	 */
+	static bool testPartialSlotsSum(long logN, long logq, long precisionBits, long logSlots);
+
 	//-----------------------------------------
 
 
@@ -84,6 +106,20 @@ public:
 	 */
 	static void testPowerOf2Batch(long logN, long logq, long precisionBits, long logDegree, long logSlots);
 
+	/**
+	 * Testing precision of truncating and rounding rescaling on power of 2 of the ciphertext
+	 * c(m_1, ..., m_slots) -> c(m_1^degree/p^{degree-1}, ..., m_slots^degree/p^{degree-1})
+	 * number of levels switched: logDegree,
+	 * rescaling in both modes is compared with division of coefficients and with multAndRescale,
+	 * errors of both modes are printed, rounding gives no measurable precision gain over truncation
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] log of power degree
+	 * @param[in] log of number of slots
+	 * @return true if rescaling equals the reference and power keeps precision in both modes
+	 */
+	static bool testRescaleRoundingBatch(long logN, long logq, long precisionBits, long logDegree, long logSlots);
+
 	//-----------------------------------------
 
 	/**
@@ -232,10 +268,254 @@ public:
 
 	//-----------------------------------------
 
+	/**
+	 * Checking ciphers with coefficients stored as 64-bit words: pack and unpack, addition, subtraction
+	 * and rescaling of packed ciphers in both rescale modes give the same ciphers as on ZZX coefficients
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] bitsDown bits of rescaling, more than 64 drops a word of coefficients
+	 * @return true if all packed operations give the same ciphers
+	 */
+	static bool testPackedCiphertext(long logN, long logq, long precisionBits, long logSlots, long bitsDown);
+
+	/**
+	 * Checking BootKey with diagonals stored as SparsePoly: bootstrapping with partial slots
+	 * gives the same cipher as the same steps with each diagonal expanded to a full polynomial
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logq0 log of modulus q0
+	 * @param[in] logT logT of bootstrap
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] logSlots log of number of slots, less than logN - 1
+	 * @param[in] backend BACKEND_ZZX or BACKEND_RNS, which multiplies by residues of diagonals in NTT form
+	 * @return true if both bootstraps give the same cipher
+	 */
+	static bool testBootKeyCompact(long logN, long logq, long logq0, long logT, long logI, long logSlots, long backend);
+
+	/**
+	 * Checking lazy BootKey against eager one: diagonals and bootstrapping are the same,
+	 * also after diagonals are evicted from cache of capacity smaller than their number
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logq0 log of modulus q0
+	 * @param[in] logT logT of bootstrap
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] logSlots log of number of slots, less than logN - 1
+	 * @param[in] capacity capacity of diagonal cache
+	 * @return true if lazy diagonals and bootstraps equal eager ones and cache stays within capacity
+	 */
+	static bool testLazyBootKey(long logN, long logq, long logq0, long logT, long logI, long logSlots, long capacity);
+
+	/**
+	 * Checking parallel construction of BootKey: dense and factored BootKeys built on NTL thread pool
+	 * with numThreads threads have the same coefficients and residues as built with one thread
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] pBits precision bits of encoded diagonals
+	 * @param[in] logSlots log of number of slots, less than logN - 1
+	 * @param[in] levels number of stages of factored BootKey
+	 * @param[in] numThreads number of threads of NTL thread pool
+	 * @return true if BootKeys are bit-identical
+	 */
+	static bool testBootKeyThreads(long logN, long logq, long pBits, long logSlots, long levels, long numThreads);
+
+	/**
+	 * Checking seeded keys: all keys are compressed to seeds and expanded back to the generated keys,
+	 * then mult, conjugate and leftRotateFast give the same ciphers and encryption with the expanded key decrypts
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] dnum number of digits of hybrid keys, 0 for keys modulo qq
+	 * @return true if expanded keys work as generated ones
+	 */
+	static bool testSeededKeys(long logN, long logq, long precisionBits, long logSlots, long dnum);
+
+	/**
+	 * Checking factored linear transforms against dense ones: CoeffToSlot, sum with conjugate and SlotToCoeff
+	 * as in bootstrapping with BootKey of levels stages give the same message as with dense BootKey
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] levels number of stages of factored transforms
+	 * @return true if both paths agree in more than precisionBits / 2 leading bits
+	 */
+	static bool testLinearTransformFactored(long logN, long logq, long precisionBits, long logSlots, long levels);
+
 	static void testBootstrap();
 
+	/**
+	 * Checking TaskScheduler: tasks spawning and waiting for nested tasks all run,
+	 * bootstrapParallel gives the same cipher as bootstrap
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logq0 log of modulus q0
+	 * @param[in] logT logT of bootstrap
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] numThreads number of worker threads of scheduler
+	 * @return true if all nested tasks run and both bootstraps give the same cipher
+	 */
+	static bool testBootstrapParallel(long logN, long logq, long logq0, long logT, long logI, long logSlots, long numThreads);
+
+	/**
+	 * Checking bootstrapping with sparse secret encapsulation against bootstrapping without it:
+	 * sparse keys change nothing unless sparse is set, sparse bootstrapping with logI of sparseh
+	 * keeps more modulus and about the same precision
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logq0 log of modulus q0
+	 * @param[in] logT logT of bootstrap
+	 * @param[in] logI bound on log of |I| without sparse secret
+	 * @param[in] sparseh hamming weight of sparse secret
+	 * @param[in] logSlots log of number of slots
+	 * @return true if all checks pass
+	 */
+	static bool testSparseBootstrap(long logN, long logq, long logq0, long logT, long logI, long sparseh, long logSlots);
+
+	/**
+	 * Checking removeIpart with EvalModPlan: ciphers of m + q0 * I are reduced to q0 / 2pi * sin(2pi * m / q0),
+	 * the measured error is compared with error estimated by the plan, removeIpart is compared with removeIpartAndEqual
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logq0 log of modulus q0
+	 * @param[in] logT logT of removeIpart
+	 * @param[in] logI bound on log of |I|
+	 * @param[in] precisionBits required bits of precision of the plan
+	 * @param[in] logSlots log of number of slots
+	 * @return true if error is within estimate and both paths give the same cipher
+	 */
+	static bool testEvalModPlan(long logN, long logq, long logq0, long logT, long logI, long precisionBits, long logSlots);
+
 	static void testBootstrapOneReal();
 
+	/**
+	 * Testing binary serialization: params, key maps and ciphertext are written and read back
+	 * into a new Context and Scheme, which bootstraps the ciphertext, corrupted ciphertext is rejected
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] log of number of slots
+	 * @return true if everything is read back and bootstrap with read keys equals bootstrap with written keys
+	 */
+	static bool testSerialization(long logN, long logq, long logSlots);
+
+	/**
+	 * Checking memory-mapped key store: keys written to a file and loaded into a Scheme with another secret key
+	 * give the same results of mult, conjugate, leftRotateFast and bootstrap, store of another Context is rejected
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] log of number of slots
+	 * @return true if all operations with loaded keys equal operations with written keys
+	 */
+	static bool testKeyStore(long logN, long logq, long logSlots);
+
+	/**
+	 * Timing of multiplications against copies of the multiplication key,
+	 * keys are taken by reference on the key switching path and should not be copied.
+	 * Time of mult, square, conjugate and leftRotateFast is compared with the same operation
+	 * plus a copy of its key, as it was done before
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] iters number of repetitions
+	 * @return true if key switching by reference gives the same cipher as with a copy of the key
+	 */
+	static bool testMultKeyCopy(long logN, long logq, long precisionBits, long logSlots, long iters);
+
+	/**
+	 * Testing hybrid key switching: power of 2 and rotation with keys split into dnum digits
+	 * against the same operations with standard keys modulo qq
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logDegree log of degree of power
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] dnum number of digits of switching keys
+	 * @return true if results with hybrid and standard keys differ in less than precisionBits / 2 bits
+	 */
+	static bool testHybridKeySwitching(long logN, long logq, long precisionBits, long logDegree, long logSlots, long dnum);
+
+	/**
+	 * Testing level keys: power of 2 with switching keys of full size and with keys reduced to each level
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logDegree log of degree of power
+	 * @param[in] logSlots log of number of slots
+	 * @return true if level keys give the same cipher as full keys
+	 */
+	static bool testLevelKeys(long logN, long logq, long precisionBits, long logDegree, long logSlots);
+
+	/**
+	 * Testing inner product: products summed before one linearization and products linearized one by one
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] size number of ciphers in each vector
+	 * @return true if both inner products differ in less than precisionBits / 2 bits
+	 */
+	static bool testInnerProd(long logN, long logq, long precisionBits, long logSlots, long size);
+
+	/**
+	 * Testing fused operations: multiplication and rescaling, multiply-accumulate and constant multiplication and rescaling
+	 * against separate operations, multiply-accumulate to accumulator at another level is rejected
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] iters number of repetitions of each operation
+	 * @return true if fused operations give the same ciphers as separate operations and accumulator at another level is rejected
+	 */
+	static bool testFusedMult(long logN, long logq, long precisionBits, long logSlots, long iters);
+
+	/**
+	 * Testing automorphisms of rotations: timing of coefficient form computed from power
+	 * against NTT form of RingMultiplier permuted with tables of Context
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] iters number of repetitions for every rotation by power of 2
+	 * @return true if automorphisms from tables equal automorphisms from power
+	 */
+	static bool testAutomorphism(long logN, long logq, long logSlots, long iters);
+
+	/**
+	 * Checking that mult and square run with default single thread, with several threads,
+	 * nested inside NTL_EXEC_RANGE and in a TaskScheduler worker, and give the same ciphers
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @param[in] numThreads number of NTL threads
+	 * @return true if all products are equal
+	 */
+	static bool testMultThreads(long logN, long logq, long precisionBits, long logSlots, long numThreads);
+
+	/**
+	 * Checking RNS backend against NTL multiplication: mult, square and multByConst of ciphers at several levels
+	 * give the same ciphers in both backends, as well as products of polynomials modulo qq that need about maxnp primes
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @param[in] precisionBits bits of precision
+	 * @param[in] logSlots log of number of slots
+	 * @return true if all results are equal
+	 */
+	static bool testRNSMult(long logN, long logq, long precisionBits, long logSlots);
+
+	/**
+	 * Checking SIMD kernels of NTT and INTT: every path supported by the machine is forced on random residues
+	 * and on residues p - 1 modulo each prime, NTT is compared with scalar NTT and INTT with the input
+	 * @param[in] logN input parameter for Params class
+	 * @param[in] logq input parameter for Params class
+	 * @return true if all transforms are equal
+	 */
+	static bool testNTTSimd(long logN, long logq);
+
 	static void testBoundOfI();
 };
 